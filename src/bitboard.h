@@ -0,0 +1,240 @@
+#pragma once
+
+#include "simd.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+namespace bits {
+
+inline unsigned int PopCount(uint64_t word) {
+#ifdef _MSC_VER
+  return static_cast<unsigned int>(__popcnt64(word));
+#else
+  return static_cast<unsigned int>(__builtin_popcountll(word));
+#endif
+}
+
+// index of the lowest set bit; word must not be zero
+inline unsigned int CountTrailingZeros(uint64_t word) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, word);
+  return static_cast<unsigned int>(index);
+#else
+  return static_cast<unsigned int>(__builtin_ctzll(word));
+#endif
+}
+
+} // namespace bits
+
+// occupancy mask with one bit per board block in row-major order,
+// i.e. block (x, y) of a board of width w is bit (x + y * w);
+// the words of masks in an array are contiguous, for the SIMD kernels
+template<size_t WordCount>
+struct BitBoard {
+  enum : size_t {
+    wordCount = WordCount,
+    bitCount = 64 * WordCount
+  };
+
+  BitBoard()
+    : m_words() {
+  }
+
+  // mask with the lowest count bits set
+  static BitBoard Fill(size_t count) {
+    BitBoard ret;
+    for(size_t i = 0; i < WordCount; ++i) {
+      if(count >= 64) {
+        ret.m_words[i] = ~uint64_t(0);
+        count -= 64;
+      } else {
+        ret.m_words[i] = (uint64_t(1) << count) - 1;
+        count = 0;
+      }
+    }
+    return ret;
+  }
+
+  bool Test(size_t pos) const {
+    return (m_words[pos / 64] >> (pos % 64)) & 1;
+  }
+
+  void Set(size_t pos) {
+    m_words[pos / 64] |= (uint64_t(1) << (pos % 64));
+  }
+
+  void Reset(size_t pos) {
+    m_words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+  }
+
+  bool Any() const {
+    uint64_t acc = 0;
+    for(size_t i = 0; i < WordCount; ++i) {
+      acc |= m_words[i];
+    }
+    return (acc != 0);
+  }
+
+  bool None() const {
+    return !Any();
+  }
+
+  // whether any bit is set in both masks
+  bool Intersects(BitBoard const &other) const {
+    uint64_t acc = 0;
+    for(size_t i = 0; i < WordCount; ++i) {
+      acc |= (m_words[i] & other.m_words[i]);
+    }
+    return (acc != 0);
+  }
+
+  // bit i set for each of the count masks, at most 64, not intersecting other
+  static uint64_t Disjoint(BitBoard const *masks, size_t count, BitBoard const &other) {
+    static_assert(sizeof(BitBoard) == sizeof(uint64_t) * WordCount, "Masks must be contiguous words");
+    if(simd::IsKernelWordCount(WordCount) && simd::kernels.disjoint) {
+      return simd::kernels.disjoint(masks->Words(), count, other.Words(), WordCount);
+    }
+
+    uint64_t ret = 0;
+    for(size_t i = 0; i < count; ++i) {
+      ret |= (uint64_t(!masks[i].Intersects(other)) << i);
+    }
+    return ret;
+  }
+
+  unsigned int Count() const {
+    unsigned int count = 0;
+    for(size_t i = 0; i < WordCount; ++i) {
+      count += bits::PopCount(m_words[i]);
+    }
+    return count;
+  }
+
+  // index of the lowest set bit; mask must not be empty
+  size_t First() const {
+    for(size_t i = 0;; ++i) {
+      if(m_words[i]) {
+        return i * 64 + bits::CountTrailingZeros(m_words[i]);
+      }
+    }
+  }
+
+  BitBoard &operator&=(BitBoard const &other) {
+    for(size_t i = 0; i < WordCount; ++i) {
+      m_words[i] &= other.m_words[i];
+    }
+    return *this;
+  }
+
+  BitBoard &operator|=(BitBoard const &other) {
+    for(size_t i = 0; i < WordCount; ++i) {
+      m_words[i] |= other.m_words[i];
+    }
+    return *this;
+  }
+
+  BitBoard &operator^=(BitBoard const &other) {
+    for(size_t i = 0; i < WordCount; ++i) {
+      m_words[i] ^= other.m_words[i];
+    }
+    return *this;
+  }
+
+  // move bits towards higher indices
+  BitBoard &operator<<=(size_t count) {
+    size_t const wordShift = count / 64;
+    size_t const bitShift = count % 64;
+    for(size_t i = WordCount; i-- > 0;) {
+      uint64_t word = 0;
+      if(i >= wordShift) {
+        word = m_words[i - wordShift] << bitShift;
+        if(bitShift && (i > wordShift)) {
+          word |= m_words[i - wordShift - 1] >> (64 - bitShift);
+        }
+      }
+      m_words[i] = word;
+    }
+    return *this;
+  }
+
+  // move bits towards lower indices
+  BitBoard &operator>>=(size_t count) {
+    size_t const wordShift = count / 64;
+    size_t const bitShift = count % 64;
+    for(size_t i = 0; i < WordCount; ++i) {
+      uint64_t word = 0;
+      if(i + wordShift < WordCount) {
+        word = m_words[i + wordShift] >> bitShift;
+        if(bitShift && (i + wordShift + 1 < WordCount)) {
+          word |= m_words[i + wordShift + 1] << (64 - bitShift);
+        }
+      }
+      m_words[i] = word;
+    }
+    return *this;
+  }
+
+  BitBoard operator~() const {
+    BitBoard ret;
+    for(size_t i = 0; i < WordCount; ++i) {
+      ret.m_words[i] = ~m_words[i];
+    }
+    return ret;
+  }
+
+  friend BitBoard operator&(BitBoard lhs, BitBoard const &rhs) {
+    return lhs &= rhs;
+  }
+
+  friend BitBoard operator|(BitBoard lhs, BitBoard const &rhs) {
+    return lhs |= rhs;
+  }
+
+  friend BitBoard operator^(BitBoard lhs, BitBoard const &rhs) {
+    return lhs ^= rhs;
+  }
+
+  friend BitBoard operator<<(BitBoard lhs, size_t count) {
+    return lhs <<= count;
+  }
+
+  friend BitBoard operator>>(BitBoard lhs, size_t count) {
+    return lhs >>= count;
+  }
+
+  friend bool operator==(BitBoard const &lhs, BitBoard const &rhs) {
+    return (lhs.m_words == rhs.m_words);
+  }
+
+  friend bool operator!=(BitBoard const &lhs, BitBoard const &rhs) {
+    return !(lhs == rhs);
+  }
+
+  // orders by the highest differing bit, to sort and look up masks
+  friend bool operator<(BitBoard const &lhs, BitBoard const &rhs) {
+    for(size_t i = WordCount; i-- > 0;) {
+      if(lhs.m_words[i] != rhs.m_words[i]) {
+        return (lhs.m_words[i] < rhs.m_words[i]);
+      }
+    }
+    return false;
+  }
+
+  uint64_t const *Words() const {
+    return m_words.data();
+  }
+
+  uint64_t *Words() {
+    return m_words.data();
+  }
+
+private:
+  std::array<uint64_t, WordCount> m_words;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// piece orientations not to be inserted at a block again,
+// one bit per orientation of all shapes for each insert position,
+// stored in one flat array of whole words per block
+struct BlackList {
+  BlackList(size_t blockCount, size_t orientationCount)
+    : m_wordCount((orientationCount + 63) / 64)
+    , m_words(blockCount * m_wordCount) {
+  }
+
+  // bit position of an orientation at an insert position
+  size_t Index(size_t pos, size_t orientationIndex) const {
+    return pos * m_wordCount * 64 + orientationIndex;
+  }
+
+  bool Test(size_t index) const {
+    return (m_words[index / 64] >> (index % 64)) & 1;
+  }
+
+  void Set(size_t index) {
+    m_words[index / 64] |= (uint64_t(1) << (index % 64));
+  }
+
+  void Reset(size_t index) {
+    m_words[index / 64] &= ~(uint64_t(1) << (index % 64));
+  }
+
+private:
+  size_t m_wordCount; // per block
+  std::vector<uint64_t> m_words;
+};
@@ -1,77 +1,147 @@
 #pragma once
 
-#include "color.h"
+#include "bitboard.h"
 #include "piece.h"
 
-#include "hypervector.h"
-
-#include <algorithm>
-#include <iostream>
-
-struct Board : public hypervector<Color, 2> {
-  Board(size_t sizeX, size_t sizeY, Color color = Color())
-    : hypervector<Color, 2>(sizeX, sizeY, color) {
-  }
-
-  bool MayInsert(Piece const &piece, size_t posX, size_t posY) const {
-    // check if piece exceeds the board
-    if((posX + piece.sizeOf<0>() > this->sizeOf<0>()) ||
-       (posY + piece.sizeOf<1>() > this->sizeOf<1>())) {
-      return false;
-    }
+// a piece inserted into the board, kept to report the solution
+template<typename Mask>
+struct PlacedPiece {
+  unsigned int id;
+  Mask mask;
+};
 
-    for(size_t y = 0; y < piece.sizeOf<1>(); ++y) {
-      for(size_t x = 0; x < piece.sizeOf<0>(); ++x) {
-        // where there is a block in the piece, none must be in the board yet
-        if(!piece.IsBlockEmpty(x, y) && !IsBlockEmpty(posX + x, posY + y)) {
-          return false;
+// board occupancy with one bit per block;
+// the board size is either given at runtime or fixed at compile time
+// by a non-zero Width and Height, making strides and shifts constants
+template<typename Mask, size_t Width = 0, size_t Height = 0>
+struct Board {
+  // sizes must match Width and Height unless these are 0
+  Board(size_t sizeX, size_t sizeY)
+    : m_sizeX(sizeX)
+    , m_sizeY(sizeY)
+    , m_occupied()
+    , m_full(Mask::Fill(sizeX * sizeY))
+    , m_notFirstColumn()
+    , m_notLastColumn() {
+    for(size_t y = 0; y < sizeY; ++y) {
+      for(size_t x = 0; x < sizeX; ++x) {
+        if(x > 0) {
+          m_notFirstColumn.Set(Offset(x, y));
+        }
+        if(x < sizeX - 1) {
+          m_notLastColumn.Set(Offset(x, y));
         }
       }
     }
+  }
 
-    return true;
+  template<size_t Dim>
+  size_t sizeOf() const {
+    return (Dim == 0 ? SizeX() : SizeY());
   }
 
-  Board Insert(Piece const &piece, size_t posX, size_t posY) const {
-    Board ret(*this);
+  // bit position of a block
+  size_t Offset(size_t posX, size_t posY) const {
+    return posX + posY * SizeX();
+  }
 
-    auto const color = Color::FromId(piece.id);
+  // mask of the piece's blocks when inserted at the board origin
+  Mask PieceMask(Piece const &piece) const {
+    Mask mask;
     for(size_t y = 0; y < piece.sizeOf<1>(); ++y) {
       for(size_t x = 0; x < piece.sizeOf<0>(); ++x) {
-        // color the board blocks with the inserted piece
         if(!piece.IsBlockEmpty(x, y)) {
-          ret.at(posX + x, posY + y) = color;
+          mask.Set(Offset(x, y));
         }
       }
     }
+    return mask;
+  }
 
-    return ret;
+  // mask is expected to be shifted to the insert position already
+  bool MayInsert(Mask const &mask) const {
+    // where there is a block in the piece, none must be in the board yet
+    return !m_occupied.Intersects(mask);
+  }
+
+  bool MayInsert(Piece const &piece, size_t posX, size_t posY) const {
+    // check if piece exceeds the board
+    if((posX + piece.sizeOf<0>() > SizeX()) ||
+       (posY + piece.sizeOf<1>() > SizeY())) {
+      return false;
+    }
+
+    return MayInsert(PieceMask(piece) << Offset(posX, posY));
+  }
+
+  void Insert(Mask const &mask) {
+    m_occupied |= mask;
+  }
+
+  // undo inserting the mask
+  void Remove(Mask const &mask) {
+    m_occupied &= ~mask;
   }
 
   bool IsSolved() const {
-    // solved when no uncolored blocks remain
-    return std::all_of(this->begin(), this->end(),
-      [](Color const &color) -> bool {
-        return color;
-      });
+    // solved when no empty blocks remain
+    return (m_occupied == m_full);
   }
 
   bool IsBlockEmpty(size_t posX, size_t posY) const {
-    return !this->at(posX, posY);
+    return !m_occupied.Test(Offset(posX, posY));
+  }
+
+  // grow the mask by the horizontally and vertically adjacent blocks
+  Mask Dilate(Mask const &mask) const {
+    return (mask
+      | ((mask << 1) & m_notFirstColumn)
+      | ((mask >> 1) & m_notLastColumn)
+      | (mask << SizeX())
+      | (mask >> SizeX())) & m_full;
   }
-};
 
-std::ostream &operator<<(std::ostream &os, Board const &board) {
-  for(size_t y = 0;; ++y) {
-    for(size_t x = 0; x < board.sizeOf<0>(); ++x) {
-      std::cout << board.at(x, y);
+  // grow the region by adjacent blocks within the given blocks
+  // until it stops growing, i.e. flood fill the blocks from the region
+  Mask Fill(Mask region, Mask const &blocks) const {
+    if(simd::IsKernelWordCount(Mask::wordCount) && simd::kernels.fill && (SizeX() < 64)) {
+      simd::kernels.fill(region.Words(), blocks.Words(),
+                         m_notFirstColumn.Words(), m_notLastColumn.Words(),
+                         SizeX(), Mask::wordCount);
+      return region;
     }
-    if(y < board.sizeOf<1>() - 1) {
-      std::cout << colorReset << "\n";
-    } else {
-      break;
+
+    for(;;) {
+      auto const grown = Dilate(region) & blocks;
+      if(grown == region) {
+        return region;
+      }
+      region = grown;
     }
   }
-  os << colorReset;
-  return os;
-}
+
+  Mask const &Occupied() const {
+    return m_occupied;
+  }
+
+  Mask Empty() const {
+    return m_full & ~m_occupied;
+  }
+
+private:
+  size_t SizeX() const {
+    return (Width ? Width : m_sizeX);
+  }
+
+  size_t SizeY() const {
+    return (Height ? Height : m_sizeY);
+  }
+
+private:
+  size_t m_sizeX;
+  size_t m_sizeY;
+  Mask m_occupied;
+  Mask m_full;
+  Mask m_notFirstColumn;
+  Mask m_notLastColumn;
+};
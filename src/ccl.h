@@ -2,263 +2,138 @@
 
 #include "board.h"
 
-#include "hypervector.h"
-
 #include <algorithm>
-#include <cassert>
-#include <iostream>
+#include <array>
 #include <limits>
-#include <unordered_map>
 
-// labeler for the empty blocks of the board that are yet to be filled
+// labeler for the empty blocks of the board that are yet to be filled;
+// components are extracted by bit-parallel flood fill of the occupancy mask
+// and kept in fixed storage, so labeling does not allocate;
+// works on boards of any size given at runtime or compile time
+template<typename Mask>
 struct ConnectedComponentLabeler {
   struct SubBoard {
-    Board board;
-    size_t offsetX;
-    size_t offsetY;
-  };
-
-private:
-  struct RegionOfInterest {
-    size_t left;
-    size_t right;
-    size_t top;
-    size_t bottom;
-
-    void Add(size_t x, size_t y) {
-      left = std::min(left, x);
-      right = std::max(right, x);
-      top = std::min(top, y);
-      bottom = std::max(bottom, y);
-    }
-
-    void Add(RegionOfInterest const &other) {
-      left = std::min(left, other.left);
-      right = std::max(right, other.right);
-      top = std::min(top, other.top);
-      bottom = std::max(bottom, other.bottom);
-    }
-  };
-
-  using Label = unsigned int;
-  enum {
-    Unlabeled = 0
-  };
-
-  struct ConnectedComponent {
-    RegionOfInterest roi;
-    unsigned int size;
+    Mask region; // the component's blocks
+    unsigned short offsetX;
+    unsigned short offsetY;
+    unsigned short sizeX;
+    unsigned short sizeY;
+    unsigned short size;
   };
 
-  friend std::ostream &operator<<(
-      std::ostream &os,
-      hypervector<Label, 2> const &labelImage);
+  // label all empty blocks of the board
+  template<typename BoardType>
+  explicit ConnectedComponentLabeler(BoardType const &board)
+    : m_subCount(0) {
+    LabelRegion(board, board.Empty());
 
-public:
-  ConnectedComponentLabeler(Board const &board)
-    : m_labelImage(board.sizeOf<0>(), board.sizeOf<1>(), Unlabeled)
-    , m_ccs() {
-    struct ConnectedComponentTemp : ConnectedComponent {
-      Label parent;
-
-      ConnectedComponentTemp(ConnectedComponent const &cc)
-        : ConnectedComponent(cc)
-        , parent(Unlabeled) {
-      }
-    };
-
-    std::unordered_map<Label, ConnectedComponentTemp> connectedComponents;
-
-    // method to assign new labels
-    Label nextLabel = 1;
-    auto newLabel = [&](Label &current, size_t x, size_t y) {
-      current = nextLabel++;
-      auto created = connectedComponents.insert(std::make_pair(current,
-        ConnectedComponent{
-          RegionOfInterest{x, x, y, y},
-          1
-        })).second;
-      assert(created);
-    };
-
-    // method to propagate labels
-    auto propagateLabel = [&](Label &current, Label neighbor, size_t x, size_t y) {
-      current = neighbor;
-      auto &&cc = connectedComponents.at(current);
-      cc.roi.Add(x, y);
-      ++cc.size;
-    };
+    m_minIndex = GetMinIndex();
+  }
 
-    // method to unify labels
-    auto unifyLabel = [&](Label &current, Label left, Label above, size_t x, size_t y) {
-      current = left;
-      auto &&cc = connectedComponents.at(left);
-      cc.roi.Add(x, y);
-      ++cc.size;
-      connectedComponents.at(above).parent = left;
-    };
+  // update a parent labeling after a piece has been inserted
+  // by relabeling only the components the piece was inserted into
+  template<typename BoardType>
+  ConnectedComponentLabeler(ConnectedComponentLabeler const &parent,
+                            BoardType const &board,
+                            Mask const &inserted) {
+    Relabel(parent, board, inserted);
+  }
 
-    // method to propagate, assign new or unify labels
-    auto label = [&](Label &current, Label left, Label above, size_t x, size_t y) {
-      if((left != Unlabeled) && (above != Unlabeled) && (left != above)) {
-        unifyLabel(current, left, above, x, y);
-      } else if(left != Unlabeled) {
-        propagateLabel(current, left, x, y);
-      } else if(above != Unlabeled) {
-        propagateLabel(current, above, x, y);
+  // like the constructor above, but reusing this labeler's storage
+  template<typename BoardType>
+  void Relabel(ConnectedComponentLabeler const &parent,
+               BoardType const &board,
+               Mask const &inserted) {
+    m_subCount = 0;
+    for(size_t i = 0; i < parent.m_subCount; ++i) {
+      auto &&sub = parent.m_subs[i];
+      if(sub.region.Intersects(inserted)) {
+        LabelRegion(board, sub.region & ~inserted);
       } else {
-        newLabel(current, x, y);
-      }
-
-#ifdef DEBUG_CCL_STEPS
-      std::cout << m_labelImage << " CCL:";
-      for(auto &&p : connectedComponents) {
-        std::cout << " ["
-          << Color::FromId(p.first) << colorReset
-          << ": parent " << Color::FromId(p.second.parent) << colorReset
-          << ", width " << p.second.roi.right - p.second.roi.left + 1
-          << ", height " << p.second.roi.bottom - p.second.roi.top + 1
-          << ", size " << p.second.size << "]";
-      }
-      std::cout << "\n\n";
-#endif
-    };
-
-    // first line
-    {
-      Label left = Unlabeled;
-      for(size_t x = 0; x < board.sizeOf<0>(); ++x) {
-        Label &current = m_labelImage.at(x, 0);
-        if(board.IsBlockEmpty(x, 0)) {
-          label(current, left, Unlabeled, x, 0);
-        }
-        left = current;
-      }
-    }
-
-    // remaining board
-    {
-      for(size_t y = 1; y < board.sizeOf<1>(); ++y) {
-        Label left = Unlabeled;
-        for(size_t x = 0; x < board.sizeOf<0>(); ++x) {
-          Label &current = m_labelImage.at(x, y);
-          if(board.IsBlockEmpty(x, y)) {
-            Label above = m_labelImage.at(x, y - 1);
-            label(current, left, above, x, y);
-          }
-          left = current;
-        }
+        m_subs[m_subCount++] = sub;
       }
     }
 
-#ifdef DEBUG_CCL_AGGREGATION
-    std::cout << m_labelImage << " CCL: non-aggregated" << std::endl;
-#endif
-
-    // aggregate results
-    for(auto &&p : connectedComponents) {
-      auto &&cc = p.second;
-      if(cc.parent != Unlabeled) {
-        auto const parentLabel = connectedComponents.at(cc.parent).parent;
-        if(parentLabel != Unlabeled) {
-          cc.parent = parentLabel;
-        }
-      }
-    }
-    for(size_t y = 0; y < board.sizeOf<1>(); ++y) {
-      for(size_t x = 0; x < board.sizeOf<0>(); ++x) {
-        auto &label = m_labelImage.at(x, y);
-        if(label != Unlabeled) {
-          auto const parentLabel = connectedComponents.at(label).parent;
-          if(parentLabel != Unlabeled) {
-            label = parentLabel;
-          }
-        }
-      }
-    }
-    for(auto &&p : connectedComponents) {
-      auto &&from = p.second;
-      if(from.parent == Unlabeled) {
-        auto &&to = m_ccs[p.first];
-        to.roi.Add(from.roi);
-        to.size += from.size;
-      } else {
-        auto &&to = m_ccs[from.parent];
-        to.roi.Add(from.roi);
-        to.size += from.size;
-      }
-    }
+    m_minIndex = GetMinIndex();
+  }
 
-    m_minLabel = GetMinLabel();
+  size_t GetCount() const {
+    return m_subCount;
+  }
 
-#ifdef DEBUG_CCL_AGGREGATION
-    std::cout << m_labelImage << " CCL: aggregated, minimum-size connected component: "
-    << Color::FromId(m_minLabel) << colorReset
-    << " size=" << GetMinSize() << std::endl;
-#endif
+  SubBoard const &Get(size_t index) const {
+    return m_subs[index];
   }
 
   unsigned int GetMinSize() const {
-    return m_ccs.at(m_minLabel).size;
+    return (m_subCount ? m_subs[m_minIndex].size : 0);
   }
 
-  // get board where the minimum-size component's blocks are uncolored
-  SubBoard GetMin() const {
-    auto &&cc = m_ccs.at(m_minLabel);
-    SubBoard sub{
-      Board(cc.roi.right - cc.roi.left + 1,
-            cc.roi.bottom - cc.roi.top + 1,
-            Color::FromId(m_minLabel)),
-      cc.roi.left,
-      cc.roi.top
-    };
+  // get the minimum-size component's blocks and bounding box
+  SubBoard const &GetMin() const {
+    return m_subs[m_minIndex];
+  }
 
-    for(size_t y = 0; y < sub.board.sizeOf<1>(); ++y) {
-      for(size_t x = 0; x < sub.board.sizeOf<0>(); ++x) {
-        if(m_labelImage.at(x + cc.roi.left, y + cc.roi.top) == m_minLabel) {
-          sub.board.at(x, y) = Color();
-        }
-      }
+private:
+  // split the given blocks into components and append them
+  template<typename BoardType>
+  void LabelRegion(BoardType const &board, Mask blocks) {
+    while(blocks.Any()) {
+      // grow from the first remaining block until nothing is added
+      Mask seed;
+      seed.Set(blocks.First());
+      auto const region = board.Fill(seed, blocks);
+      blocks &= ~region;
+
+      m_subs[m_subCount++] = CreateSubBoard(board, region);
     }
+  }
 
-    return sub;
+  template<typename BoardType>
+  static SubBoard CreateSubBoard(BoardType const &board, Mask const &region) {
+    auto const sizeX = board.template sizeOf<0>();
+    auto left = std::numeric_limits<size_t>::max();
+    size_t right = 0;
+    auto top = std::numeric_limits<size_t>::max();
+    size_t bottom = 0;
+    unsigned short size = 0;
+    for(auto blocks = region; blocks.Any(); ++size) {
+      auto const pos = blocks.First();
+      blocks.Reset(pos);
+
+      auto const x = pos % sizeX;
+      auto const y = pos / sizeX;
+      left = std::min(left, x);
+      right = std::max(right, x);
+      top = std::min(top, y);
+      bottom = std::max(bottom, y);
+    }
+
+    return SubBoard{
+      region,
+      static_cast<unsigned short>(left),
+      static_cast<unsigned short>(top),
+      static_cast<unsigned short>(right - left + 1),
+      static_cast<unsigned short>(bottom - top + 1),
+      size
+    };
   }
 
-private:
-  Label GetMinLabel() const {
-    Label minLabel = Unlabeled;
+  size_t GetMinIndex() const {
+    size_t minIndex = 0;
     auto minSize = std::numeric_limits<unsigned int>::max();
-    for(auto &&p : m_ccs) {
-      auto &&cc = p.second;
-      if(cc.size < minSize) {
-        minSize = cc.size;
-        minLabel = p.first;
+    for(size_t i = 0; i < m_subCount; ++i) {
+      if(m_subs[i].size < minSize) {
+        minSize = m_subs[i].size;
+        minIndex = i;
       }
     }
-    return minLabel;
+    return minIndex;
   }
 
 private:
-  hypervector<Label, 2> m_labelImage;
-  std::unordered_map<Label, ConnectedComponent> m_ccs;
-  Label m_minLabel;
+  // a board of n blocks has at most (n + 1) / 2 separate components
+  std::array<SubBoard, Mask::bitCount / 2 + 1> m_subs;
+  size_t m_subCount;
+  size_t m_minIndex;
 };
-
-std::ostream &operator<<(
-    std::ostream &os,
-    hypervector<ConnectedComponentLabeler::Label, 2> const &labelImage) {
-  for(size_t y = 0;; ++y) {
-    for(size_t x = 0; x < labelImage.sizeOf<0>(); ++x) {
-      auto const label = labelImage.at(x, y);
-      auto const color = (label == ConnectedComponentLabeler::Unlabeled ? Color() : Color::FromId(label));
-      os << color;
-    }
-    if(y < labelImage.sizeOf<1>() - 1) {
-      os << colorReset << "\n";
-    } else {
-      break;
-    }
-  }
-  os << colorReset;
-  return os;
-}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "hypervector.h"
+
 #include <iostream>
 #include <vector>
 
@@ -61,7 +63,23 @@ private:
   ColorCode m_colorCode;
 };
 
-std::ostream &operator<<(std::ostream &os, Color const &color) {
+inline std::ostream &operator<<(std::ostream &os, Color const &color) {
   os << "\x1B[" << color.m_colorCode << "m" << ' ' << ' ';
   return os;
 }
+
+// print the colored blocks row by row
+inline std::ostream &operator<<(std::ostream &os, hypervector<Color, 2> const &colors) {
+  for(size_t y = 0;; ++y) {
+    for(size_t x = 0; x < colors.sizeOf<0>(); ++x) {
+      os << colors.at(x, y);
+    }
+    if(y < colors.sizeOf<1>() - 1) {
+      os << colorReset << "\n";
+    } else {
+      break;
+    }
+  }
+  os << colorReset;
+  return os;
+}
@@ -0,0 +1,388 @@
+#pragma once
+
+#include "puzzle.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct CommandLineArguments {
+  enum class Format {
+    Json,
+    Csv
+  };
+
+  enum class Render {
+    Ansi,
+    Plain,
+    Json
+  };
+
+  // of generated puzzles, by the number of search nodes
+  enum class Difficulty {
+    Any,
+    Easy, // below 1000
+    Medium, // below 100000
+    Hard
+  };
+
+  Puzzle puzzle; // in batch mode, only the number of threads is used
+  std::string batchPath; // empty unless in batch mode
+  std::string servePath; // empty unless in server mode
+  size_t cacheCapacity; // of the server's result cache, in puzzles
+  std::string dbPath; // of a solution database to look puzzles up in, if any
+  std::string generateDbPath; // empty unless generating a solution database
+  size_t maxBlockCount; // of the boards of the generated database
+  size_t generateCount; // of random puzzles to generate, 0 unless generating them
+  unsigned long long seed; // of the random puzzles
+  unsigned int nearMissPercent; // share of unsolvable random puzzles
+  Difficulty difficulty; // of the random puzzles
+  Format format;
+  Render render; // of the solutions
+  simd::Level simdLevel; // of the kernels for large boards, capped to what the CPU supports
+  std::string checkpointPath; // empty unless a stopped search is to be saved
+  std::string puzzleArgs; // the arguments but those of checkpoints, to save with one
+  Checkpoint resumed; // of the resumed search, the puzzle points to it
+
+  // first line of a checkpoint file, followed by the arguments and the checkpoint
+  static constexpr char const *checkpointHeader = "# tetris_puzzle_solver checkpoint";
+
+  CommandLineArguments(int argc, char **argv)
+    : CommandLineArguments() {
+    try {
+      Parse(std::vector<std::string>(argv + 1, argv + argc));
+    }
+    catch(std::invalid_argument const &e) {
+      std::cout << e.what() << "\n\n";
+      std::cout << "Usage:\n" << argv[0];
+      std::cout << R"(
+  -w <board width>
+  -h <board height>
+  -I <number of 'I' pieces> (optional)
+  -L <number of 'L' pieces> (optional)
+  -J <number of 'J' pieces> (optional)
+  -T <number of 'T' pieces> (optional)
+  -Z <number of 'Z' pieces> (optional)
+  -S <number of 'S' pieces> (optional)
+  -O <number of 'O' pieces> (optional)
+  --shapes <shape file> (optional, see shapes/pentominoes.txt)
+  -<shape name> <number of pieces of a shape of the shape file> (optional)
+  --engine <search|dlx> (optional, dlx requires the pieces to cover the board exactly)
+  --branching <region|first|fewest> (optional, placements the search tries: those filling the block
+    with the fewest (default) or the first empty block, or all in the smallest region; exact covers only)
+  -j <number of search threads> (optional)
+  --tt-mb <transposition table megabytes> (optional, 0 to disable, single thread only)
+  --region-table <number of blocks> (optional, largest region looked up as fillable or not, up to 12, default 8, 0 to disable)
+  --count (optional, count all solutions, symmetric ones included)
+  --all (optional, like --count and print one of each set of symmetric solutions)
+  --stats (optional, print search statistics)
+  --render <ansi|plain|json> (optional, how to print solutions)
+  --simd <scalar|sse2|avx2> (optional, instruction set for boards of over 128 blocks, default the best supported)
+  --timeout <seconds> (optional, stop the search after the time, the result is then unknown)
+  --max-nodes <number of search nodes> (optional, stop the search after about as many nodes)
+  --checkpoint <file> (optional, save a search stopped by the limits or Ctrl-C to resume it, single thread only)
+  --resume <checkpoint file> (optional, resume the saved search with its arguments, followed by the given ones)
+  --db <solution database file> (optional, look tetromino puzzles up before searching, also in the modes below)
+
+Batch mode:
+)" << argv[0] << R"(
+  --batch <file with the arguments above for one puzzle per line, or - for stdin>
+  -j <number of puzzles solved at a time> (optional)
+  --format <json|csv> (optional, of the result line per puzzle)
+
+Server mode:
+)" << argv[0] << R"(
+  --serve <Unix domain socket path, or - for stdin>
+    (answers a line of the arguments above for one puzzle with a result line, as in batch mode)
+  --cache <number of puzzles> (optional, results kept for equivalent puzzles, default 1024, 0 to disable)
+  --format <json|csv> (optional, of the result line per puzzle)
+
+Solution database generation:
+)" << argv[0] << R"(
+  --generate-db <file>
+  --max-area <number of board blocks> (optional, default 80, at most 256)
+  -j <number of puzzles solved at a time> (optional)
+  --timeout <seconds> / --max-nodes <number of search nodes> (optional, per puzzle, the others are left out)
+
+Random puzzle generation, printed in batch file format:
+)" << argv[0] << R"(
+  -w <board width>
+  -h <board height>
+  --generate <number of puzzles>
+  --seed <number> (optional, default 1, the same seed gives the same puzzles)
+  --near-miss <percent> (optional, default 25, share of unsolvable puzzles with one piece swapped)
+  --difficulty <easy|medium|hard> (optional, below 1000 or 100000 search nodes, or above)
+  plus the search arguments above to score the puzzles with
+)";
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // parse the arguments of a batch file line
+  explicit CommandLineArguments(std::vector<std::string> const &args)
+    : CommandLineArguments() {
+    Parse(args);
+  }
+
+  static simd::Level ParseSimdLevel(std::string const &value) {
+    for(auto level : {simd::Level::Scalar, simd::Level::Sse2, simd::Level::Avx2}) {
+      if(value == simd::ToString(level)) {
+        return level;
+      }
+    }
+    throw std::invalid_argument("Invalid instruction set: '" + value + "'");
+  }
+
+private:
+  CommandLineArguments()
+    : cacheCapacity(1024)
+    , maxBlockCount(80)
+    , generateCount(0)
+    , seed(1)
+    , nearMissPercent(25)
+    , difficulty(Difficulty::Any)
+    , format(Format::Json)
+    , render(Render::Ansi)
+    , simdLevel(simd::GetSupportedLevel()) {
+  }
+
+  void Parse(std::vector<std::string> const &args) {
+    if(args.empty()) {
+      throw std::invalid_argument("Invalid number of arguments");
+    } else {
+      bool gotWidth = false;
+      bool gotHeight = false;
+      std::vector<std::pair<char, unsigned int>> pieceCounts;
+
+      for(size_t argi = 0; argi < args.size(); ++argi) {
+        std::string const &identifier = args[argi];
+        if((identifier != "--checkpoint") && (identifier != "--resume")) {
+          puzzleArgs += (puzzleArgs.empty() ? "" : " ") + identifier;
+          if((argi + 1 < args.size()) && !IsFlag(identifier)) {
+            puzzleArgs += " " + args[argi + 1];
+          }
+        }
+
+        // flags go without a value
+        if(identifier == "--count") {
+          puzzle.solutions = Puzzle::Solutions::Count;
+          continue;
+        } else if(identifier == "--all") {
+          puzzle.solutions = Puzzle::Solutions::All;
+          continue;
+        } else if(identifier == "--stats") {
+          puzzle.isCollectingStats = true;
+          continue;
+        } else if(argi + 1 == args.size()) {
+          throw std::invalid_argument("Missing value of argument: '" + identifier + "'");
+        }
+        std::string const &value = args[++argi];
+
+        if(identifier == "-w") {
+          ParseValue(puzzle.boardWidth, value, "board width");
+          gotWidth = true;
+        } else if(identifier == "-h") {
+          ParseValue(puzzle.boardHeight, value, "board height");
+          gotHeight = true;
+        } else if((identifier.size() == 2) &&
+                  (identifier[0] == '-') &&
+                  std::isupper(static_cast<unsigned char>(identifier[1]))) {
+          // resolved once the shape file is known
+          unsigned int count;
+          ParseValue(count, value, "number of '" + identifier.substr(1) + "' pieces");
+          pieceCounts.emplace_back(identifier[1], count);
+        } else if(identifier == "--shapes") {
+          std::ifstream file(value);
+          if(!file) {
+            throw std::invalid_argument("Failed to open shape file: '" + value + "'");
+          }
+          puzzle.shapes = ReadShapes(file);
+        } else if(identifier == "-j") {
+          ParseValue(puzzle.threadCount, value, "number of threads");
+          if(!puzzle.threadCount) {
+            throw std::invalid_argument("Invalid number of threads: '" + value + "'");
+          }
+        } else if(identifier == "--tt-mb") {
+          ParseValue(puzzle.transpositionTableMegabytes, value, "transposition table size");
+        } else if(identifier == "--region-table") {
+          ParseValue(puzzle.smallRegionBlockCount, value, "region table size");
+          if(puzzle.smallRegionBlockCount > 12) {
+            // the table takes long to build beyond
+            throw std::invalid_argument("Invalid region table size: '" + value + "'");
+          }
+        } else if(identifier == "--engine") {
+          if(value == "search") {
+            puzzle.engine = Puzzle::Engine::Search;
+          } else if(value == "dlx") {
+            puzzle.engine = Puzzle::Engine::DancingLinks;
+          } else {
+            throw std::invalid_argument("Invalid engine: '" + value + "'");
+          }
+        } else if(identifier == "--branching") {
+          if(value == "region") {
+            puzzle.branching = Puzzle::Branching::SmallestRegion;
+          } else if(value == "first") {
+            puzzle.branching = Puzzle::Branching::FirstEmpty;
+          } else if(value == "fewest") {
+            puzzle.branching = Puzzle::Branching::FewestCandidates;
+          } else {
+            throw std::invalid_argument("Invalid branching: '" + value + "'");
+          }
+        } else if(identifier == "--batch") {
+          batchPath = value;
+        } else if(identifier == "--serve") {
+          servePath = value;
+        } else if(identifier == "--cache") {
+          ParseValue(cacheCapacity, value, "cache size");
+        } else if(identifier == "--db") {
+          dbPath = value;
+        } else if(identifier == "--generate-db") {
+          generateDbPath = value;
+        } else if(identifier == "--max-area") {
+          ParseValue(maxBlockCount, value, "board area");
+        } else if(identifier == "--generate") {
+          ParseValue(generateCount, value, "number of puzzles");
+        } else if(identifier == "--seed") {
+          ParseValue(seed, value, "seed");
+        } else if(identifier == "--near-miss") {
+          ParseValue(nearMissPercent, value, "near-miss percentage");
+          if(nearMissPercent > 100) {
+            throw std::invalid_argument("Invalid near-miss percentage: '" + value + "'");
+          }
+        } else if(identifier == "--difficulty") {
+          if(value == "easy") {
+            difficulty = Difficulty::Easy;
+          } else if(value == "medium") {
+            difficulty = Difficulty::Medium;
+          } else if(value == "hard") {
+            difficulty = Difficulty::Hard;
+          } else {
+            throw std::invalid_argument("Invalid difficulty: '" + value + "'");
+          }
+        } else if(identifier == "--format") {
+          if(value == "json") {
+            format = Format::Json;
+          } else if(value == "csv") {
+            format = Format::Csv;
+          } else {
+            throw std::invalid_argument("Invalid format: '" + value + "'");
+          }
+        } else if(identifier == "--render") {
+          if(value == "ansi") {
+            render = Render::Ansi;
+          } else if(value == "plain") {
+            render = Render::Plain;
+          } else if(value == "json") {
+            render = Render::Json;
+          } else {
+            throw std::invalid_argument("Invalid rendering: '" + value + "'");
+          }
+        } else if(identifier == "--simd") {
+          simdLevel = ParseSimdLevel(value);
+        } else if(identifier == "--timeout") {
+          if(!(std::istringstream(value) >> puzzle.timeoutSeconds) || (puzzle.timeoutSeconds < 0.0)) {
+            throw std::invalid_argument("Invalid timeout: '" + value + "'");
+          }
+        } else if(identifier == "--max-nodes") {
+          ParseValue(puzzle.maxNodeCount, value, "number of nodes");
+        } else if(identifier == "--checkpoint") {
+          checkpointPath = value;
+        } else if(identifier == "--resume") {
+          Resume(value);
+          gotWidth = true;
+          gotHeight = true;
+        } else {
+          throw std::invalid_argument("Unknown argument: '" + identifier + "'");
+        }
+      }
+
+      // shapes of the shape file take precedence over the tetrominoes
+      for(auto &&pieceCount : pieceCounts) {
+        auto const shape = std::find_if(begin(puzzle.shapes), end(puzzle.shapes),
+          [&](Puzzle::Shape const &shape) -> bool {
+            return (shape.name == pieceCount.first);
+          });
+        if(shape != end(puzzle.shapes)) {
+          shape->count = pieceCount.second;
+        } else {
+          *GetTetrominoCount(pieceCount.first) = pieceCount.second;
+        }
+      }
+
+      if(batchPath.empty() && servePath.empty() && generateDbPath.empty() && (!gotWidth || !gotHeight)) {
+        throw std::invalid_argument("Board width and height must be provided");
+      }
+    }
+  }
+
+  static bool IsFlag(std::string const &identifier) {
+    return ((identifier == "--count") || (identifier == "--all") || (identifier == "--stats"));
+  }
+
+  // parse the arguments saved with the checkpoint and read the checkpoint
+  void Resume(std::string const &path) {
+    std::ifstream file(path);
+    std::string header;
+    std::string argsLine;
+    if(!file ||
+       !std::getline(file, header) || (header != checkpointHeader) ||
+       !std::getline(file, argsLine) || (argsLine.compare(0, 5, "args ") != 0)) {
+      throw std::invalid_argument("Failed to read checkpoint file: '" + path + "'");
+    }
+
+    std::istringstream iss(argsLine.substr(5));
+    std::vector<std::string> args;
+    for(std::string arg; iss >> arg;) {
+      args.push_back(arg);
+    }
+    Parse(args);
+
+    resumed = ReadCheckpoint(file);
+    puzzle.resume = &resumed;
+  }
+
+  unsigned int *GetTetrominoCount(char name) {
+    switch(name) {
+    case 'I':
+      return &puzzle.piecesCountI;
+    case 'L':
+      return &puzzle.piecesCountL;
+    case 'J':
+      return &puzzle.piecesCountJ;
+    case 'T':
+      return &puzzle.piecesCountT;
+    case 'Z':
+      return &puzzle.piecesCountZ;
+    case 'S':
+      return &puzzle.piecesCountS;
+    case 'O':
+      return &puzzle.piecesCountO;
+    default:
+      throw std::invalid_argument(std::string("Unknown shape: '") + name + "'");
+    }
+  }
+
+  // counts and sizes, so negative values are invalid rather than wrapped around
+  template<typename T>
+  void ParseValue(T &value, std::string const &arg, std::string const &argName) {
+    static_assert(std::is_unsigned<T>::value, "unsigned values only");
+    unsigned long long num;
+    if((arg.find_first_not_of(" \t") == std::string::npos) ||
+       (arg[arg.find_first_not_of(" \t")] == '-') ||
+       !(std::istringstream(arg) >> num) ||
+       (num > std::numeric_limits<T>::max())) {
+      throw std::invalid_argument("Invalid " + argName + ": '" + arg + "'");
+    }
+    value = static_cast<T>(num);
+  }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "board.h"
+#include "limits.h"
+#include "placement.h"
+
+#include <vector>
+
+// exact cover solver using Knuth's dancing links (algorithm X)
+// for puzzles where the pieces cover the board exactly;
+// every board block is a primary column, every piece shape a column
+// that is only covered once all pieces of that shape have been inserted
+template<typename Mask>
+struct DancingLinks {
+  using PlacedPieces = std::vector<PlacedPiece<Mask>>;
+
+  unsigned long long nodeCount;
+  SearchLimits *limits; // optional, to stop before the search is complete
+  bool isStopped; // by the limits
+
+  DancingLinks(Board<Mask> const &board, PlacementTable<Mask> const &placementTable)
+    : nodeCount(0)
+    , limits(nullptr)
+    , isStopped(false)
+    , m_uncheckedNodeCount(0)
+    , m_cellCount(board.template sizeOf<0>() * board.template sizeOf<1>())
+    , m_shapeCount(placementTable.shapes.size()) {
+    auto const columnCount = m_cellCount + m_shapeCount;
+
+    // root and column headers; block columns are linked to the root,
+    // shape columns link to themselves only so they are never chosen
+    m_nodes.resize(1 + columnCount);
+    m_sizes.resize(1 + columnCount, 0);
+    for(size_t c = 0; c <= columnCount; ++c) {
+      auto &&node = m_nodes[c];
+      node.up = node.down = node.column = c;
+      node.row = NoRow;
+      if(c <= m_cellCount) {
+        node.left = (c == 0 ? m_cellCount : c - 1);
+        node.right = (c == m_cellCount ? 0 : c + 1);
+      } else {
+        node.left = node.right = c;
+      }
+    }
+
+    // one row per piece position
+    for(size_t shapeIndex = 0; shapeIndex < m_shapeCount; ++shapeIndex) {
+      for(auto &&orientation : placementTable.shapes[shapeIndex].orientations) {
+        for(auto &&mask : orientation.masks) {
+          AddRow(shapeIndex, mask);
+        }
+      }
+    }
+  }
+
+  // find a single solution for the given number of pieces per shape
+  bool Solve(PieceCounts const &pieceCounts, PlacedPieces &placedPieces) {
+    m_pieceCounts = pieceCounts;
+    for(size_t shapeIndex = 0; shapeIndex < m_shapeCount; ++shapeIndex) {
+      if(!m_pieceCounts[shapeIndex]) {
+        Cover(ShapeColumn(shapeIndex));
+      }
+    }
+
+    bool const isSolved = Search(placedPieces);
+
+    for(size_t shapeIndex = m_shapeCount; shapeIndex-- > 0;) {
+      if(!m_pieceCounts[shapeIndex]) {
+        Uncover(ShapeColumn(shapeIndex));
+      }
+    }
+
+    return isSolved;
+  }
+
+private:
+  enum : size_t {
+    Root = 0,
+    NoRow = ~size_t(0)
+  };
+
+  struct Node {
+    size_t left;
+    size_t right;
+    size_t up;
+    size_t down;
+    size_t column;
+    size_t row;
+  };
+
+  struct Row {
+    size_t shapeIndex;
+    Mask mask;
+  };
+
+  size_t ShapeColumn(size_t shapeIndex) const {
+    return 1 + m_cellCount + shapeIndex;
+  }
+
+  bool IsShapeColumn(size_t column) const {
+    return (column > m_cellCount);
+  }
+
+  void AddRow(size_t shapeIndex, Mask mask) {
+    auto const row = m_rows.size();
+    m_rows.push_back(Row{shapeIndex, mask});
+
+    auto const first = m_nodes.size();
+    auto append = [&](size_t column) {
+      auto const index = m_nodes.size();
+      Node node;
+      node.left = (index == first ? index : index - 1);
+      node.right = first;
+      node.up = m_nodes[column].up;
+      node.down = column;
+      node.column = column;
+      node.row = row;
+      m_nodes.push_back(node);
+
+      m_nodes[node.left].right = index;
+      m_nodes[first].left = index;
+      m_nodes[node.up].down = index;
+      m_nodes[column].up = index;
+      ++m_sizes[column];
+    };
+
+    for(; mask.Any(); mask.Reset(mask.First())) {
+      append(1 + mask.First());
+    }
+    append(ShapeColumn(shapeIndex));
+  }
+
+  void Cover(size_t column) {
+    m_nodes[m_nodes[column].right].left = m_nodes[column].left;
+    m_nodes[m_nodes[column].left].right = m_nodes[column].right;
+    for(auto i = m_nodes[column].down; i != column; i = m_nodes[i].down) {
+      for(auto j = m_nodes[i].right; j != i; j = m_nodes[j].right) {
+        m_nodes[m_nodes[j].down].up = m_nodes[j].up;
+        m_nodes[m_nodes[j].up].down = m_nodes[j].down;
+        --m_sizes[m_nodes[j].column];
+      }
+    }
+  }
+
+  void Uncover(size_t column) {
+    for(auto i = m_nodes[column].up; i != column; i = m_nodes[i].up) {
+      for(auto j = m_nodes[i].left; j != i; j = m_nodes[j].left) {
+        ++m_sizes[m_nodes[j].column];
+        m_nodes[m_nodes[j].down].up = j;
+        m_nodes[m_nodes[j].up].down = j;
+      }
+    }
+    m_nodes[m_nodes[column].right].left = column;
+    m_nodes[m_nodes[column].left].right = column;
+  }
+
+  // cover the columns of a row other than the chosen one;
+  // a shape column is covered once no pieces of that shape remain
+  void Select(size_t node) {
+    for(auto j = m_nodes[node].right; j != node; j = m_nodes[j].right) {
+      auto const column = m_nodes[j].column;
+      if(IsShapeColumn(column)) {
+        auto &&count = m_pieceCounts[column - 1 - m_cellCount];
+        if(!--count) {
+          Cover(column);
+        }
+      } else {
+        Cover(column);
+      }
+    }
+  }
+
+  void Deselect(size_t node) {
+    for(auto j = m_nodes[node].left; j != node; j = m_nodes[j].left) {
+      auto const column = m_nodes[j].column;
+      if(IsShapeColumn(column)) {
+        auto &&count = m_pieceCounts[column - 1 - m_cellCount];
+        if(!count++) {
+          Uncover(column);
+        }
+      } else {
+        Uncover(column);
+      }
+    }
+  }
+
+  bool Search(PlacedPieces &placedPieces) {
+    if(limits && (++m_uncheckedNodeCount >= limits->checkInterval)) {
+      isStopped = limits->Check(m_uncheckedNodeCount);
+      m_uncheckedNodeCount = 0;
+      if(isStopped) {
+        return false;
+      }
+    }
+    ++nodeCount;
+    if(m_nodes[Root].right == Root) {
+      // all board blocks are covered
+      return true;
+    }
+
+    // choose the block with the fewest remaining candidate rows
+    auto column = m_nodes[Root].right;
+    for(auto c = m_nodes[column].right; c != Root; c = m_nodes[c].right) {
+      if(m_sizes[c] < m_sizes[column]) {
+        column = c;
+      }
+    }
+    if(!m_sizes[column]) {
+      return false;
+    }
+
+    Cover(column);
+    for(auto i = m_nodes[column].down; i != column; i = m_nodes[i].down) {
+      Select(i);
+
+      auto const id = static_cast<unsigned int>(placedPieces.size());
+      placedPieces.push_back(PlacedPiece<Mask>{id, m_rows[m_nodes[i].row].mask});
+      if(Search(placedPieces)) {
+        Deselect(i);
+        Uncover(column);
+        return true;
+      }
+      placedPieces.pop_back();
+
+      Deselect(i);
+      if(isStopped) {
+        break;
+      }
+    }
+    Uncover(column);
+
+    return false;
+  }
+
+private:
+  unsigned long long m_uncheckedNodeCount; // since checking the limits
+  size_t m_cellCount;
+  size_t m_shapeCount;
+  std::vector<Node> m_nodes;
+  std::vector<size_t> m_sizes;
+  std::vector<Row> m_rows;
+  PieceCounts m_pieceCounts;
+};
@@ -0,0 +1,244 @@
+#include "generator.h"
+
+#include "bitboard.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// steps per board block of the first tiling attempt, doubled per restart
+enum : unsigned long long {
+  tilingStepsPerBlock = 100
+};
+
+// empty regions of up to as many blocks are checked to be fillable
+enum : size_t {
+  maxHoleBlockCount = 32
+};
+
+unsigned int *GetCount(Puzzle &puzzle, size_t shapeIndex) {
+  unsigned int *const counts[] = {
+    &puzzle.piecesCountI, &puzzle.piecesCountL, &puzzle.piecesCountJ, &puzzle.piecesCountT,
+    &puzzle.piecesCountZ, &puzzle.piecesCountS, &puzzle.piecesCountO
+  };
+  return counts[shapeIndex];
+}
+
+} // unnamed namespace
+
+PuzzleGenerator::PuzzleGenerator(size_t width, size_t height, uint64_t seed)
+  : m_isTransposed(width > height)
+  , m_width(m_isTransposed ? height : width)
+  , m_height(m_isTransposed ? width : height)
+  , m_random(seed) {
+  if(!width || !height || ((width * height) % 4)) {
+    throw std::invalid_argument("Board size not divisible into tetrominoes");
+  }
+  if(width * height > BitBoard<8>::bitCount) {
+    // as the solver, which scores the puzzles
+    throw std::invalid_argument("Board too large (at most " + std::to_string(BitBoard<8>::bitCount) + " blocks supported)");
+  }
+
+  // the distinct orientations of each tetromino
+  Piece (*const creates[])(unsigned int) = {
+    &Piece::CreateI, &Piece::CreateL, &Piece::CreateJ, &Piece::CreateT,
+    &Piece::CreateZ, &Piece::CreateS, &Piece::CreateO
+  };
+  for(size_t shapeIndex = 0; shapeIndex < 7; ++shapeIndex) {
+    std::vector<Piece> pieces;
+    auto piece = creates[shapeIndex](0);
+    do {
+      if(std::none_of(begin(pieces), end(pieces),
+          [&](Piece const &other) -> bool {
+            return piece.HasSameBlocks(other);
+          })) {
+        pieces.push_back(piece);
+      }
+    } while(piece.RotateRight());
+
+    m_shapes.emplace_back();
+    for(auto &&orientation : pieces) {
+      Orientation blocks{shapeIndex, {}};
+      for(size_t y = 0; y < orientation.sizeOf<1>(); ++y) {
+        for(size_t x = 0; x < orientation.sizeOf<0>(); ++x) {
+          if(!orientation.IsBlockEmpty(x, y)) {
+            blocks.blocks.emplace_back(static_cast<int>(x), static_cast<int>(y));
+          }
+        }
+      }
+      // relative to the first block, which is the one filled first
+      auto const first = blocks.blocks.front();
+      blocks.blocks.erase(begin(blocks.blocks));
+      for(auto &&block : blocks.blocks) {
+        block.first -= first.first;
+        block.second -= first.second;
+      }
+      m_shapes.back().push_back(blocks);
+    }
+  }
+}
+
+Puzzle PuzzleGenerator::GenerateSolvable() {
+  // a tiling that got stuck is restarted in another random order,
+  // with more steps each time; all boards of the constructor's sizes
+  // can be tiled, with I or with O pieces
+  std::vector<unsigned int> counts;
+  for(auto maxStepCount = tilingStepsPerBlock * m_width * m_height;; maxStepCount *= 2) {
+    m_isFilled.assign(m_width * m_height, false);
+    counts.assign(m_shapes.size(), 0);
+    unsigned long long stepCount = maxStepCount;
+    if(Tile(0, counts, stepCount)) {
+      break;
+    }
+  }
+
+  Puzzle puzzle;
+  puzzle.boardWidth = (m_isTransposed ? m_height : m_width);
+  puzzle.boardHeight = (m_isTransposed ? m_width : m_height);
+  for(size_t shapeIndex = 0; shapeIndex < counts.size(); ++shapeIndex) {
+    *GetCount(puzzle, shapeIndex) = counts[shapeIndex];
+  }
+  if(m_isTransposed) {
+    // the tiling transposed back mirrors its pieces
+    std::swap(puzzle.piecesCountL, puzzle.piecesCountJ);
+    std::swap(puzzle.piecesCountZ, puzzle.piecesCountS);
+  }
+  return puzzle;
+}
+
+Puzzle PuzzleGenerator::SwapPiece(Puzzle const &puzzle) {
+  auto swapped = puzzle;
+  std::vector<size_t> shapeIndices;
+  for(size_t shapeIndex = 0; shapeIndex < m_shapes.size(); ++shapeIndex) {
+    if(*GetCount(swapped, shapeIndex)) {
+      shapeIndices.push_back(shapeIndex);
+    }
+  }
+  auto const from = shapeIndices[Random(shapeIndices.size())];
+  auto const to = (from + 1 + Random(m_shapes.size() - 1)) % m_shapes.size();
+  --*GetCount(swapped, from);
+  ++*GetCount(swapped, to);
+  return swapped;
+}
+
+std::string PuzzleGenerator::ToArgs(Puzzle const &puzzle) {
+  std::ostringstream os;
+  os << "-w " << puzzle.boardWidth
+    << " -h " << puzzle.boardHeight
+    << " -T " << puzzle.piecesCountT
+    << " -J " << puzzle.piecesCountJ
+    << " -L " << puzzle.piecesCountL
+    << " -O " << puzzle.piecesCountO
+    << " -Z " << puzzle.piecesCountZ
+    << " -S " << puzzle.piecesCountS
+    << " -I " << puzzle.piecesCountI;
+  return os.str();
+}
+
+// fill the first empty block from pos on with a piece of a random shape
+// and orientation, backtracking if the rest cannot be filled;
+// gives up when the steps left run out
+bool PuzzleGenerator::Tile(size_t pos, std::vector<unsigned int> &counts, unsigned long long &stepCount) {
+  while((pos < m_isFilled.size()) && m_isFilled[pos]) {
+    ++pos;
+  }
+  if(pos == m_isFilled.size()) {
+    return true;
+  } else if(!stepCount) {
+    return false;
+  }
+  --stepCount;
+
+  // shapes in random order, so each is as likely as the others
+  std::vector<size_t> shapeIndices(m_shapes.size());
+  for(size_t i = 0; i < shapeIndices.size(); ++i) {
+    shapeIndices[i] = i;
+  }
+  for(size_t i = shapeIndices.size(); i > 1; --i) {
+    std::swap(shapeIndices[i - 1], shapeIndices[Random(i)]);
+  }
+
+  auto const posX = static_cast<int>(pos % m_width);
+  auto const posY = static_cast<int>(pos / m_width);
+  for(auto shapeIndex : shapeIndices) {
+    auto &&orientations = m_shapes[shapeIndex];
+    auto const firstOrientation = Random(orientations.size());
+    for(size_t i = 0; i < orientations.size(); ++i) {
+      auto &&orientation = orientations[(firstOrientation + i) % orientations.size()];
+      auto const fits = std::all_of(begin(orientation.blocks), end(orientation.blocks),
+        [&](std::pair<int, int> const &block) -> bool {
+          auto const x = posX + block.first;
+          auto const y = posY + block.second;
+          return ((x >= 0) && (x < static_cast<int>(m_width)) &&
+                  (y < static_cast<int>(m_height)) &&
+                  !m_isFilled[y * m_width + x]);
+        });
+      if(!fits) {
+        continue;
+      }
+
+      auto const fill = [&](bool isFilled) {
+        m_isFilled[pos] = isFilled;
+        for(auto &&block : orientation.blocks) {
+          m_isFilled[(posY + block.second) * m_width + posX + block.first] = isFilled;
+        }
+      };
+      fill(true);
+      ++counts[shapeIndex];
+      if(MayFillAround(pos, orientation) && Tile(pos + 1, counts, stepCount)) {
+        return true;
+      }
+      --counts[shapeIndex];
+      fill(false);
+    }
+  }
+  return false;
+}
+
+// whether the small empty regions next to the piece at pos,
+// enclosed by it, have a multiple of 4 blocks, as they must to be filled
+bool PuzzleGenerator::MayFillAround(size_t pos, Orientation const &orientation) const {
+  auto const posX = static_cast<int>(pos % m_width);
+  auto const posY = static_cast<int>(pos / m_width);
+  std::vector<std::pair<int, int>> pieceBlocks(1, std::make_pair(posX, posY));
+  for(auto &&block : orientation.blocks) {
+    pieceBlocks.emplace_back(posX + block.first, posY + block.second);
+  }
+
+  auto const isEmpty = [&](int x, int y) -> bool {
+    return ((x >= 0) && (x < static_cast<int>(m_width)) &&
+            (y >= 0) && (y < static_cast<int>(m_height)) &&
+            !m_isFilled[y * m_width + x]);
+  };
+  int const stepsX[] = {1, -1, 0, 0};
+  int const stepsY[] = {0, 0, 1, -1};
+
+  std::vector<std::pair<int, int>> region;
+  for(auto &&block : pieceBlocks) {
+    for(size_t step = 0; step < 4; ++step) {
+      auto const seed = std::make_pair(block.first + stepsX[step], block.second + stepsY[step]);
+      if(!isEmpty(seed.first, seed.second)) {
+        continue;
+      }
+
+      // flood fill until the region turns out to be large
+      region.assign(1, seed);
+      for(size_t i = 0; (i < region.size()) && (region.size() <= maxHoleBlockCount); ++i) {
+        for(size_t next = 0; next < 4; ++next) {
+          auto const neighbor = std::make_pair(region[i].first + stepsX[next], region[i].second + stepsY[next]);
+          if(isEmpty(neighbor.first, neighbor.second) &&
+             (std::find(begin(region), end(region), neighbor) == end(region))) {
+            region.push_back(neighbor);
+          }
+        }
+      }
+      if((region.size() <= maxHoleBlockCount) && (region.size() % 4)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
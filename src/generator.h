@@ -0,0 +1,50 @@
+#pragma once
+
+#include "piece.h"
+#include "puzzle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// random tetromino puzzles of a board size for load tests,
+// the same for the same seed
+struct PuzzleGenerator {
+  // throws std::invalid_argument unless the board's blocks divide into pieces
+  // and there are no more of them than the solver supports
+  PuzzleGenerator(size_t width, size_t height, uint64_t seed);
+
+  // the pieces of a random tiling of the board, so solvable
+  Puzzle GenerateSolvable();
+
+  // the puzzle with one piece swapped for one of another shape,
+  // which makes most puzzles unsolvable, yet fills the board
+  Puzzle SwapPiece(Puzzle const &puzzle);
+
+  // the arguments of the puzzle, as in a batch file
+  static std::string ToArgs(Puzzle const &puzzle);
+
+private:
+  // blocks of a piece orientation relative to its first block in row-major order
+  struct Orientation {
+    size_t shapeIndex;
+    std::vector<std::pair<int, int>> blocks;
+  };
+
+  bool Tile(size_t pos, std::vector<unsigned int> &counts, unsigned long long &stepCount); // steps left
+  bool MayFillAround(size_t pos, Orientation const &orientation) const;
+
+  size_t Random(size_t count) {
+    return static_cast<size_t>(m_random() % count);
+  }
+
+  bool m_isTransposed; // whether the board is tiled transposed, so along its shorter rows
+  size_t m_width; // of the tiled board
+  size_t m_height;
+  std::mt19937_64 m_random; // its numbers are the same on all platforms
+  std::vector<std::vector<Orientation>> m_shapes; // per tetromino, as in the puzzle
+  std::vector<bool> m_isFilled; // per board block
+};
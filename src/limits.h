@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+// when to stop a search before it is complete, shared by all solvers
+// of a puzzle; each solver checks it every checkInterval nodes
+struct SearchLimits {
+  using Clock = std::chrono::steady_clock;
+
+  enum class Reason {
+    None,
+    Timeout,
+    NodeCount,
+    Request
+  };
+
+  unsigned long long checkInterval;
+
+  // no limit for 0 seconds or nodes
+  SearchLimits(double seconds,
+               unsigned long long maxNodeCount,
+               std::atomic<bool> const *stopRequest)
+    : checkInterval(1024)
+    , m_hasDeadline(seconds > 0.0)
+    , m_deadline(Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds)))
+    , m_maxNodeCount(maxNodeCount)
+    , m_stopRequest(stopRequest)
+    , m_nodeCount(0)
+    , m_reason(Reason::None) {
+    if(maxNodeCount && (maxNodeCount < checkInterval)) {
+      checkInterval = maxNodeCount;
+    }
+  }
+
+  // add the nodes a solver searched since its last check;
+  // returns whether to stop
+  bool Check(unsigned long long nodeCount) {
+    auto const totalNodeCount = (m_nodeCount += nodeCount);
+    auto reason = Reason::None;
+    if(m_stopRequest && m_stopRequest->load()) {
+      reason = Reason::Request;
+    } else if(m_maxNodeCount && (totalNodeCount >= m_maxNodeCount)) {
+      reason = Reason::NodeCount;
+    } else if(m_hasDeadline && (Clock::now() >= m_deadline)) {
+      reason = Reason::Timeout;
+    } else {
+      return IsReached();
+    }
+
+    // keep the reason found first
+    auto expected = Reason::None;
+    m_reason.compare_exchange_strong(expected, reason);
+    return true;
+  }
+
+  bool IsReached() const {
+    return (m_reason.load() != Reason::None);
+  }
+
+  Reason GetReason() const {
+    return m_reason.load();
+  }
+
+private:
+  bool m_hasDeadline;
+  Clock::time_point m_deadline;
+  unsigned long long m_maxNodeCount;
+  std::atomic<bool> const *m_stopRequest;
+  std::atomic<unsigned long long> m_nodeCount; // of all solvers
+  std::atomic<Reason> m_reason;
+};
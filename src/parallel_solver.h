@@ -0,0 +1,175 @@
+#pragma once
+
+#include "board.h"
+#include "placement.h"
+#include "pruning.h"
+#include "solver.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// runs one solver per thread; a solver hands off branches of its search
+// when others are idle and the idle ones steal them,
+// all stop as soon as one of them finds a solution unless counting
+template<typename Mask, size_t Width = 0, size_t Height = 0>
+struct ParallelSolver {
+  using SolverType = Solver<Mask, Width, Height>;
+  using Task = typename SolverType::Task;
+  using PlacedPieces = typename SolverType::PlacedPieces;
+
+  // the solvers are copies of the given one
+  ParallelSolver(SolverType const &solver, unsigned int threadCount)
+    : m_isCancelled(false)
+    , m_pendingCount(0)
+    , m_queuedCount(0)
+    , m_idleCount(0) {
+    for(unsigned int i = 0; i < threadCount; ++i) {
+      m_workers.emplace_back(new Worker(*this, i, solver));
+    }
+  }
+
+  // when solved, placedPieces holds the solution
+  bool Solve(Task task, PlacedPieces &placedPieces) {
+    m_isCancelled = false;
+    m_isSolved = false;
+    Push(0, std::unique_ptr<Task>(new Task(std::move(task))));
+
+    std::vector<std::thread> threads;
+    for(auto &&worker : m_workers) {
+      threads.emplace_back(&ParallelSolver::Run, this, std::ref(*worker));
+    }
+    for(auto &&thread : threads) {
+      thread.join();
+    }
+
+    if(m_isSolved) {
+      placedPieces = m_solution;
+    }
+    return m_isSolved;
+  }
+
+  // add the counters of all solvers to the given one
+  void Accumulate(SolverType &solver) const {
+    for(auto &&worker : m_workers) {
+      solver.Accumulate(worker->solver);
+    }
+  }
+
+private:
+  struct Worker : SolverType::Sharing {
+    ParallelSolver &parallel;
+    size_t index;
+    SolverType solver;
+    std::mutex mutex;
+    std::deque<std::unique_ptr<Task>> tasks;
+
+    Worker(ParallelSolver &parallel,
+           size_t index,
+           SolverType const &solver)
+      : parallel(parallel)
+      , index(index)
+      , solver(solver) {
+      this->solver.sharing = this;
+    }
+
+    bool IsCancelled() const override {
+      return parallel.m_isCancelled;
+    }
+
+    bool WantsTask() const override {
+      return (parallel.m_idleCount > parallel.m_queuedCount);
+    }
+
+    void Share(Task task) override {
+      parallel.Push(index, std::unique_ptr<Task>(new Task(std::move(task))));
+    }
+  };
+
+  void Push(size_t index, std::unique_ptr<Task> task) {
+    ++m_pendingCount;
+    ++m_queuedCount;
+    {
+      auto &&worker = *m_workers[index];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.tasks.push_back(std::move(task));
+    }
+    m_idleCondition.notify_one();
+  }
+
+  // take the most recent of the worker's own tasks,
+  // or else the oldest, i.e. largest, task of another worker
+  bool TryTake(size_t index, std::unique_ptr<Task> &task) {
+    for(size_t i = 0; i < m_workers.size(); ++i) {
+      auto &&worker = *m_workers[(index + i) % m_workers.size()];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if(!worker.tasks.empty()) {
+        if(i == 0) {
+          task = std::move(worker.tasks.back());
+          worker.tasks.pop_back();
+        } else {
+          task = std::move(worker.tasks.front());
+          worker.tasks.pop_front();
+        }
+        --m_queuedCount;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // wait for a task until the search has ended
+  bool Take(size_t index, std::unique_ptr<Task> &task) {
+    for(;;) {
+      if(m_isCancelled) {
+        return false;
+      }
+      if(TryTake(index, task)) {
+        return true;
+      }
+      if(!m_pendingCount) {
+        return false;
+      }
+
+      std::unique_lock<std::mutex> lock(m_idleMutex);
+      ++m_idleCount;
+      m_idleCondition.wait_for(lock, std::chrono::milliseconds(1));
+      --m_idleCount;
+    }
+  }
+
+  void Run(Worker &worker) {
+    std::unique_ptr<Task> task;
+    while(Take(worker.index, task)) {
+      if(worker.solver.Solve(*task)) {
+        std::lock_guard<std::mutex> lock(m_solutionMutex);
+        if(!m_isSolved) {
+          m_isSolved = true;
+          m_solution = task->placedPieces;
+        }
+        m_isCancelled = true;
+      }
+
+      if(!--m_pendingCount) {
+        m_idleCondition.notify_all();
+      }
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::atomic<bool> m_isCancelled;
+  std::atomic<unsigned int> m_pendingCount; // queued and running tasks
+  std::atomic<unsigned int> m_queuedCount;
+  std::atomic<unsigned int> m_idleCount;
+  std::mutex m_idleMutex;
+  std::condition_variable m_idleCondition;
+  std::mutex m_solutionMutex;
+  bool m_isSolved;
+  PlacedPieces m_solution;
+};
@@ -4,25 +4,31 @@
 
 #include <algorithm>
 #include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 struct Piece : public hypervector<unsigned char, 2> {
   struct Type {
     char shape;
     unsigned char rotationCount;
+    bool isMirrored;
 
     bool operator==(Type const &other) const {
       return ((shape == other.shape) &&
-              (rotationCount == other.rotationCount));
+              (rotationCount == other.rotationCount) &&
+              (isMirrored == other.isMirrored));
     }
   };
 
   unsigned int id;
   Type type;
+  bool isMirrorable; // may be flipped over, else its mirror image is another shape
 
   Piece() = default;
 
   static Piece CreateI(unsigned int id) {
-    return Piece(1, 4, id, 'i', 2);
+    return Piece(1, 4, id, 'i');
   }
 
   static Piece CreateL(unsigned int id) {
@@ -47,21 +53,60 @@ struct Piece : public hypervector<unsigned char, 2> {
   }
 
   static Piece CreateZ(unsigned int id) {
-    Piece piece(3, 2, id, 'z', 2);
+    Piece piece(3, 2, id, 'z');
     piece.at(0, 1) = 0x00;
     piece.at(2, 0) = 0x00;
     return piece;
   }
 
   static Piece CreateS(unsigned int id) {
-    Piece piece(3, 2, id, 's', 2);
+    Piece piece(3, 2, id, 's');
     piece.at(0, 0) = 0x00;
     piece.at(2, 1) = 0x00;
     return piece;
   }
 
   static Piece CreateO(unsigned int id) {
-    return Piece(2, 2, id, 'o', 3);
+    return Piece(2, 2, id, 'o');
+  }
+
+  // create a piece of any shape from rows of '#' for blocks
+  // and '.' or ' ' for empty blocks, trimmed to its blocks
+  static Piece Create(unsigned int id,
+                      char shape,
+                      std::vector<std::string> const &rows,
+                      bool isMirrorable) {
+    auto left = std::string::npos;
+    size_t right = 0;
+    auto top = std::string::npos;
+    size_t bottom = 0;
+    for(size_t y = 0; y < rows.size(); ++y) {
+      for(size_t x = 0; x < rows[y].size(); ++x) {
+        if(rows[y][x] == '#') {
+          left = std::min(left, x);
+          right = std::max(right, x);
+          top = std::min(top, y);
+          bottom = std::max(bottom, y);
+        } else if((rows[y][x] != '.') && (rows[y][x] != ' ')) {
+          throw std::invalid_argument(std::string("Invalid block of shape '") + shape + "': '" + rows[y][x] + "'");
+        }
+      }
+    }
+    if(left == std::string::npos) {
+      throw std::invalid_argument(std::string("Shape '") + shape + "' has no blocks");
+    }
+
+    Piece piece(right - left + 1, bottom - top + 1, id, shape);
+    for(size_t y = 0; y < piece.sizeOf<1>(); ++y) {
+      auto &&row = rows[top + y];
+      for(size_t x = 0; x < piece.sizeOf<0>(); ++x) {
+        if((left + x >= row.size()) || (row[left + x] != '#')) {
+          piece.at(x, y) = 0x00;
+        }
+      }
+    }
+    piece.isMirrorable = isMirrorable;
+    return piece;
   }
 
   bool IsBlockEmpty(size_t posX, size_t posY) const {
@@ -79,6 +124,24 @@ struct Piece : public hypervector<unsigned char, 2> {
       });
   }
 
+  // whether both pieces cover the same blocks, regardless of id and type
+  bool HasSameBlocks(Piece const &other) const {
+    if((this->sizeOf<0>() != other.sizeOf<0>()) ||
+       (this->sizeOf<1>() != other.sizeOf<1>())) {
+      return false;
+    }
+    for(size_t y = 0; y < this->sizeOf<1>(); ++y) {
+      for(size_t x = 0; x < this->sizeOf<0>(); ++x) {
+        if(IsBlockEmpty(x, y) != other.IsBlockEmpty(x, y)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // rotate by 90 degrees; fails after the third rotation
+  // as there are no further distinct orientations
   bool RotateRight() {
     if(type.rotationCount >= 3) {
       return false;
@@ -107,14 +170,33 @@ struct Piece : public hypervector<unsigned char, 2> {
     return true;
   }
 
+  // flip over horizontally and start rotating again;
+  // fails if the piece may not be flipped or is flipped already
+  bool Mirror() {
+    if(!isMirrorable || type.isMirrored) {
+      return false;
+    }
+    type.isMirrored = true;
+    type.rotationCount = 0;
+
+    auto const offsetX = this->sizeOf<0>() - 1;
+    for(size_t y = 0; y < this->sizeOf<1>(); ++y) {
+      for(size_t x = 0; x < this->sizeOf<0>() / 2; ++x) {
+        std::swap(this->at(x, y), this->at(offsetX - x, y));
+      }
+    }
+
+    return true;
+  }
+
 private:
   Piece(size_t sizeX,
         size_t sizeY,
         unsigned int id,
-        char type,
-        unsigned char rotationCount = 0)
+        char type)
     : hypervector<unsigned char, 2>(sizeX, sizeY, 0xFF)
     , id(id)
-    , type({type, rotationCount}) {
+    , type({type, 0, false})
+    , isMirrorable(false) {
   }
 };
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "board.h"
+#include "piece.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// number of pieces per shape of the placement table
+using PieceCounts = std::vector<unsigned int>;
+
+// every distinct orientation of the pieces' shapes
+// and every position where it fits into the board,
+// built once before the search so the search only does lookups
+template<typename Mask>
+struct PlacementTable {
+  struct Orientation {
+    Piece::Type type;
+    size_t sizeX;
+    size_t sizeY;
+    size_t positionCountX; // number of insert positions per board row
+    std::vector<Mask> masks; // piece mask per insert position
+    size_t firstIndex; // placement number of the first insert position
+    size_t index; // orientation number, unique over all shapes
+
+    // piece mask shifted to the insert position
+    Mask const &At(size_t posX, size_t posY) const {
+      return masks[posX + posY * positionCountX];
+    }
+
+    // placement number of the insert position, unique over all shapes
+    size_t IndexAt(size_t posX, size_t posY) const {
+      return firstIndex + posX + posY * positionCountX;
+    }
+  };
+
+  struct Shape {
+    char name;
+    unsigned int blockCount;
+    std::vector<Orientation> orientations;
+  };
+
+  std::vector<Shape> shapes;
+  size_t orientationCount;
+  size_t placementCount;
+
+  PlacementTable(Board<Mask> const &board, std::vector<Piece> const &pieces)
+    : orientationCount(0)
+    , placementCount(0) {
+    for(auto &&piece : pieces) {
+      if(std::none_of(begin(shapes), end(shapes),
+          [&](Shape const &shape) -> bool {
+            return (shape.name == piece.type.shape);
+          })) {
+        shapes.push_back(CreateShape(board, piece));
+      }
+    }
+
+    // number the orientations and placements
+    // in the order of shapes, orientations and positions
+    for(auto &&shape : shapes) {
+      for(auto &&orientation : shape.orientations) {
+        orientation.index = orientationCount++;
+        orientation.firstIndex = placementCount;
+        placementCount += orientation.masks.size();
+      }
+    }
+  }
+
+  size_t IndexOf(char name) const {
+    for(size_t i = 0; i < shapes.size(); ++i) {
+      if(shapes[i].name == name) {
+        return i;
+      }
+    }
+    throw std::out_of_range("Unknown piece shape");
+  }
+
+  // shape of an inserted piece, by comparing with all placements
+  size_t ShapeIndexOf(Mask const &mask) const {
+    for(size_t i = 0; i < shapes.size(); ++i) {
+      for(auto &&orientation : shapes[i].orientations) {
+        if(std::find(begin(orientation.masks), end(orientation.masks), mask) != end(orientation.masks)) {
+          return i;
+        }
+      }
+    }
+    throw std::out_of_range("Unknown piece mask");
+  }
+
+private:
+  static Shape CreateShape(Board<Mask> const &board, Piece piece) {
+    Shape shape{piece.type.shape, piece.GetBlockCount(), {}};
+
+    // rotations, and those of the mirror image if the piece may be flipped
+    std::vector<Piece> distinct;
+    do {
+      // skip orientations that look the same as a previous one
+      if(std::any_of(begin(distinct), end(distinct),
+          [&](Piece const &other) -> bool {
+            return other.HasSameBlocks(piece);
+          })) {
+        continue;
+      }
+      distinct.push_back(piece);
+
+      // skip orientations that do not fit into the board at all
+      auto const sizeX = piece.sizeOf<0>();
+      auto const sizeY = piece.sizeOf<1>();
+      if((sizeX > board.template sizeOf<0>()) ||
+         (sizeY > board.template sizeOf<1>())) {
+        continue;
+      }
+
+      Orientation orientation{
+        piece.type,
+        sizeX,
+        sizeY,
+        board.template sizeOf<0>() - sizeX + 1,
+        {},
+        0,
+        0
+      };
+      auto const pieceMask = board.PieceMask(piece);
+      for(size_t y = 0; y + sizeY <= board.template sizeOf<1>(); ++y) {
+        for(size_t x = 0; x + sizeX <= board.template sizeOf<0>(); ++x) {
+          orientation.masks.push_back(pieceMask << board.Offset(x, y));
+        }
+      }
+      shape.orientations.push_back(std::move(orientation));
+    } while(piece.RotateRight() || piece.Mirror());
+
+    return shape;
+  }
+};
+
+// the placements covering each board block, grouped by shape,
+// to branch on the placements that fill a given block;
+// a group's masks are contiguous so they are tested at once
+template<typename Mask>
+struct CoveringTable {
+  using Orientation = typename PlacementTable<Mask>::Orientation;
+
+  struct Candidate {
+    Orientation const *orientation;
+    size_t posX;
+    size_t posY;
+  };
+
+  std::vector<Mask> masks;
+  std::vector<Candidate> candidates; // per mask
+
+  // with isFirstBlockOnly, only the placements whose lowest block is the
+  // covered one, i.e. those fitting when all lower blocks are filled
+  CoveringTable(Board<Mask> const &board,
+                PlacementTable<Mask> const &placementTable,
+                bool isFirstBlockOnly)
+    : m_shapeCount(placementTable.shapes.size()) {
+    auto const blockCount = board.template sizeOf<0>() * board.template sizeOf<1>();
+    m_firsts.reserve(blockCount * m_shapeCount + 1);
+    for(size_t pos = 0; pos < blockCount; ++pos) {
+      for(auto &&shape : placementTable.shapes) {
+        m_firsts.push_back(masks.size());
+        for(auto &&orientation : shape.orientations) {
+          for(size_t posY = 0; posY + orientation.sizeY <= board.template sizeOf<1>(); ++posY) {
+            for(size_t posX = 0; posX < orientation.positionCountX; ++posX) {
+              auto &&mask = orientation.At(posX, posY);
+              if(isFirstBlockOnly ? (mask.First() == pos) : mask.Test(pos)) {
+                masks.push_back(mask);
+                candidates.push_back(Candidate{&orientation, posX, posY});
+              }
+            }
+          }
+        }
+      }
+    }
+    m_firsts.push_back(masks.size());
+  }
+
+  // index of the first placement of the shape covering the block
+  size_t Begin(size_t pos, size_t shapeIndex) const {
+    return m_firsts[pos * m_shapeCount + shapeIndex];
+  }
+
+  // index past the last placement of the shape covering the block
+  size_t End(size_t pos, size_t shapeIndex) const {
+    return m_firsts[pos * m_shapeCount + shapeIndex + 1];
+  }
+
+private:
+  size_t m_shapeCount;
+  std::vector<size_t> m_firsts; // per block and shape, then the end
+};
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "board.h"
+#include "ccl.h"
+#include "placement.h"
+#include "tileability.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// necessary conditions for the remaining pieces to fill the empty blocks,
+// checked after labeling to cut off dead branches early
+template<typename Mask>
+struct Pruner {
+  enum Reason {
+    RegionSize,   // a region is smaller than any remaining piece
+    Area,         // the remaining pieces exceed the usable area
+    RegionSum,    // a region size is no sum of remaining piece sizes
+    Checkerboard, // checkerboard coloring imbalance unreachable
+    Columns,      // alternating column coloring imbalance unreachable
+    Rows,         // alternating row coloring imbalance unreachable
+    SmallRegion,  // a small region no remaining pieces fill
+    ReasonCount
+  };
+
+  // number of branches cut off per reason
+  std::array<unsigned long long, ReasonCount> prunedCounts;
+
+  // the ways to fill small regions, if looked up
+  TileabilityTable<Mask> const *tileabilityTable;
+
+  // the region sum and coloring rules only hold
+  // if the pieces are to cover the board exactly
+  Pruner(Board<Mask> const &board,
+         PlacementTable<Mask> const &placementTable,
+         bool isExactCover)
+    : prunedCounts()
+    , tileabilityTable(nullptr)
+    , m_isExactCover(isExactCover) {
+    for(auto &&shape : placementTable.shapes) {
+      m_blockCounts.push_back(shape.blockCount);
+    }
+
+    for(size_t coloring = 0; coloring < ColoringCount; ++coloring) {
+      auto &&black = m_blacks[coloring];
+      for(size_t y = 0; y < board.template sizeOf<1>(); ++y) {
+        for(size_t x = 0; x < board.template sizeOf<0>(); ++x) {
+          if(IsBlack(static_cast<Coloring>(coloring), x, y)) {
+            black.Set(board.Offset(x, y));
+          }
+        }
+      }
+
+      for(auto &&shape : placementTable.shapes) {
+        m_imbalances[coloring].push_back(GetImbalance(shape, black));
+      }
+    }
+  }
+
+  static char const *ReasonName(Reason reason) {
+    static char const *const names[ReasonCount] = {
+      "region size",
+      "area",
+      "region sum",
+      "checkerboard",
+      "columns",
+      "rows",
+      "small region"
+    };
+    return names[reason];
+  }
+
+  template<typename BoardType>
+  bool MaySolve(BoardType const &board,
+                ConnectedComponentLabeler<Mask> const &ccl,
+                PieceCounts const &pieceCounts) {
+    unsigned int minBlockCount = std::numeric_limits<unsigned int>::max();
+    unsigned int maxBlockCount = 0;
+    unsigned int piecesArea = 0;
+    for(size_t i = 0; i < pieceCounts.size(); ++i) {
+      if(pieceCounts[i]) {
+        minBlockCount = std::min(minBlockCount, m_blockCounts[i]);
+        maxBlockCount = std::max(maxBlockCount, m_blockCounts[i]);
+        piecesArea += pieceCounts[i] * m_blockCounts[i];
+      }
+    }
+
+    if(ccl.GetMinSize() < minBlockCount) {
+      return Prune(RegionSize);
+    }
+
+    // regions too small for any piece stay empty
+    unsigned int usableArea = 0;
+    for(size_t i = 0; i < ccl.GetCount(); ++i) {
+      auto const size = ccl.Get(i).size;
+      if(size >= minBlockCount) {
+        usableArea += size;
+      }
+    }
+    if(piecesArea > usableArea) {
+      return Prune(Area);
+    }
+
+    if(!m_isExactCover) {
+      return true;
+    }
+
+    if(!MaySumRegions(ccl, pieceCounts, minBlockCount, maxBlockCount, piecesArea)) {
+      return Prune(RegionSum);
+    }
+
+    auto const empty = board.Empty();
+    auto const emptyCount = static_cast<int>(empty.Count());
+    for(size_t coloring = 0; coloring < ColoringCount; ++coloring) {
+      auto const blackCount = static_cast<int>((empty & m_blacks[coloring]).Count());
+      if(!MayBalance(coloring, pieceCounts, 2 * blackCount - emptyCount)) {
+        return Prune(static_cast<Reason>(Checkerboard + coloring));
+      }
+    }
+
+    if(tileabilityTable && !MayFillSmallRegions(board, ccl, pieceCounts)) {
+      return Prune(SmallRegion);
+    }
+
+    return true;
+  }
+
+private:
+  enum Coloring {
+    ColoringCheckerboard,
+    ColoringColumns,
+    ColoringRows,
+    ColoringCount
+  };
+
+  // how much a shape may change the difference of
+  // empty black and empty white blocks of a coloring
+  struct Imbalance {
+    int first;          // difference of any one of its placements
+    int maxMagnitude;   // largest magnitude of any of its placements
+    int step;           // gcd of the differences between its placements
+  };
+
+  static bool IsBlack(Coloring coloring, size_t x, size_t y) {
+    switch(coloring) {
+    case ColoringCheckerboard:
+      return ((x + y) % 2 == 0);
+    case ColoringColumns:
+      return (x % 2 == 0);
+    default:
+      return (y % 2 == 0);
+    }
+  }
+
+  static int Gcd(int a, int b) {
+    a = std::abs(a);
+    b = std::abs(b);
+    while(b) {
+      auto const t = a % b;
+      a = b;
+      b = t;
+    }
+    return a;
+  }
+
+  static Imbalance GetImbalance(typename PlacementTable<Mask>::Shape const &shape,
+                                Mask const &black) {
+    Imbalance imbalance{0, 0, 0};
+    bool isFirst = true;
+    for(auto &&orientation : shape.orientations) {
+      for(auto &&mask : orientation.masks) {
+        auto const blackCount = static_cast<int>((mask & black).Count());
+        auto const difference = 2 * blackCount - static_cast<int>(shape.blockCount);
+        if(isFirst) {
+          imbalance.first = difference;
+          isFirst = false;
+        }
+        imbalance.maxMagnitude = std::max(imbalance.maxMagnitude, std::abs(difference));
+        imbalance.step = Gcd(imbalance.step, difference - imbalance.first);
+      }
+    }
+    return imbalance;
+  }
+
+  bool Prune(Reason reason) {
+    ++prunedCounts[reason];
+    return false;
+  }
+
+  // whether each region could be filled by a selection of the remaining pieces
+  bool MaySumRegions(ConnectedComponentLabeler<Mask> const &ccl,
+                     PieceCounts const &pieceCounts,
+                     unsigned int minBlockCount,
+                     unsigned int maxBlockCount,
+                     unsigned int piecesArea) const {
+    if(ccl.GetCount() < 2) {
+      // a single region is filled by all pieces
+      return true;
+    }
+
+    if(minBlockCount == maxBlockCount) {
+      for(size_t i = 0; i < ccl.GetCount(); ++i) {
+        if(ccl.Get(i).size % minBlockCount) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // sums of piece sizes reachable with the remaining pieces,
+    // all regions are smaller than the sum of all pieces
+    Mask sums;
+    sums.Set(0);
+    for(size_t i = 0; i < pieceCounts.size(); ++i) {
+      for(unsigned int n = 0; n < pieceCounts[i]; ++n) {
+        sums |= (sums << m_blockCounts[i]);
+      }
+    }
+    for(size_t i = 0; i < ccl.GetCount(); ++i) {
+      auto const size = ccl.Get(i).size;
+      if((size < piecesArea) && !sums.Test(size)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // whether each small region is one the remaining pieces may fill,
+  // looked up with its blocks moved to the board's corner
+  template<typename BoardType>
+  bool MayFillSmallRegions(BoardType const &board,
+                           ConnectedComponentLabeler<Mask> const &ccl,
+                           PieceCounts const &pieceCounts) const {
+    for(size_t i = 0; i < ccl.GetCount(); ++i) {
+      auto &&sub = ccl.Get(i);
+      if((sub.size <= tileabilityTable->maxBlockCount) &&
+         !tileabilityTable->MayFill(sub.region >> board.Offset(sub.offsetX, sub.offsetY), pieceCounts)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // whether the remaining pieces may cancel out the coloring's difference
+  bool MayBalance(size_t coloring,
+                  PieceCounts const &pieceCounts,
+                  int difference) const {
+    int sum = 0;
+    int maxMagnitude = 0;
+    int step = 0;
+    for(size_t i = 0; i < pieceCounts.size(); ++i) {
+      auto const count = static_cast<int>(pieceCounts[i]);
+      if(count) {
+        auto &&imbalance = m_imbalances[coloring][i];
+        sum += count * imbalance.first;
+        maxMagnitude += count * imbalance.maxMagnitude;
+        step = Gcd(step, imbalance.step);
+      }
+    }
+
+    if(std::abs(difference) > maxMagnitude) {
+      return false;
+    }
+    return (step ? (difference - sum) % step == 0 : difference == sum);
+  }
+
+private:
+  bool m_isExactCover;
+  std::vector<unsigned int> m_blockCounts;
+  std::array<Mask, ColoringCount> m_blacks;
+  std::array<std::vector<Imbalance>, ColoringCount> m_imbalances;
+};
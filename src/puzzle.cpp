@@ -0,0 +1,614 @@
+#include "puzzle.h"
+
+#include "bitboard.h"
+#include "board.h"
+#include "ccl.h"
+#include "dlx.h"
+#include "limits.h"
+#include "parallel_solver.h"
+#include "piece.h"
+#include "placement.h"
+#include "solver.h"
+#include "symmetry.h"
+#include "tileability.h"
+#include "transposition.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <string>
+#include <vector>
+
+#ifdef DEBUG_ALLOCATIONS
+# include <atomic>
+# include <cstdlib>
+# include <iostream>
+# include <new>
+
+namespace {
+std::atomic<unsigned long long> allocationCount(0);
+} // unnamed namespace
+
+// count heap allocations to check the search does not allocate
+void *operator new(std::size_t size) {
+  ++allocationCount;
+  if(void *ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+#endif
+
+namespace {
+
+// pass a note about the puzzle on at once and keep it for the result
+void Note(SolutionSink *sink, Result &result, std::string const &text) {
+  if(sink) {
+    sink->Note(text);
+  }
+  result.message += (result.message.empty() ? "" : "; ") + text;
+}
+
+// a search stopped at the limits is not complete, unless it has found
+// the first solution; only a single search solver can resume it
+void NoteStop(SearchLimits const &limits, SolutionSink *sink, Result &result) {
+  result.status = Result::Status::Unknown;
+  switch(limits.GetReason()) {
+  case SearchLimits::Reason::Timeout:
+    Note(sink, result, "Search stopped (timeout)");
+    break;
+  case SearchLimits::Reason::NodeCount:
+    Note(sink, result, "Search stopped (node limit)");
+    break;
+  default:
+    Note(sink, result, "Search stopped (interrupted)");
+    break;
+  }
+}
+
+// the solution's pieces as shape letters and block coordinates
+template<typename Mask>
+Result::Placements GetPlacements(PlacementTable<Mask> const &placementTable,
+                                 size_t boardWidth,
+                                 std::vector<PlacedPiece<Mask>> const &placedPieces) {
+  Result::Placements placements;
+  for(auto &&placed : placedPieces) {
+    auto const shape = placementTable.shapes[placementTable.ShapeIndexOf(placed.mask)].name;
+    Result::Placement placement{static_cast<char>(std::toupper(shape)), {}};
+    for(auto mask = placed.mask; mask.Any();) {
+      auto const pos = mask.First();
+      mask.Reset(pos);
+      placement.blocks.emplace_back(pos % boardWidth, pos / boardWidth);
+    }
+    placements.push_back(std::move(placement));
+  }
+  return placements;
+}
+
+// passes the solutions of the solvers on to the puzzle's sink,
+// one at a time
+template<typename Mask, size_t Width, size_t Height>
+struct SinkAdapter : Solver<Mask, Width, Height>::Sink {
+  SinkAdapter(SolutionSink &sink,
+              PlacementTable<Mask> const &placementTable,
+              size_t boardWidth)
+    : m_sink(sink)
+    , m_placementTable(placementTable)
+    , m_boardWidth(boardWidth) {
+  }
+
+  bool Receive(typename Solver<Mask, Width, Height>::PlacedPieces const &placedPieces,
+               bool isCovering) override {
+    auto const placements = GetPlacements(m_placementTable, m_boardWidth, placedPieces);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (m_sink.Receive(placements, isCovering) == SolutionSink::Action::Continue);
+  }
+
+private:
+  SolutionSink &m_sink;
+  PlacementTable<Mask> const &m_placementTable;
+  size_t m_boardWidth;
+  std::mutex m_mutex;
+};
+
+// run recursive solver with a board mask type wide enough for the board,
+// specialized for the board size unless Width and Height are 0
+template<typename Mask, size_t Width, size_t Height>
+bool Solve(Puzzle const &puzzle,
+           Puzzle::Engine engine,
+           std::vector<Piece> const &pieces,
+           bool isExactCover,
+           SolutionSink *sink,
+           Result &result) {
+  Board<Mask> board(puzzle.boardWidth, puzzle.boardHeight);
+
+  // look up piece orientations and positions instead of rotating pieces
+  PlacementTable<Mask> const placementTable(board, pieces);
+
+  // search on the number of pieces per shape rather than on single pieces
+  PieceCounts pieceCounts(placementTable.shapes.size(), 0);
+  for(auto &&piece : pieces) {
+    ++pieceCounts[placementTable.IndexOf(piece.type.shape)];
+  }
+
+  using SolverType = Solver<Mask, Width, Height>;
+
+  typename SolverType::PlacedPieces placedPieces;
+  placedPieces.reserve(pieces.size());
+
+  auto const report = [&]() {
+    result.placements = GetPlacements(placementTable, puzzle.boardWidth, placedPieces);
+    if(sink) {
+      sink->Receive(result.placements, true);
+    }
+  };
+
+  SearchLimits limits(puzzle.timeoutSeconds, puzzle.maxNodeCount, puzzle.stopRequest);
+
+  if(engine == Puzzle::Engine::DancingLinks) {
+    DancingLinks<Mask> dlx(board, placementTable);
+    dlx.limits = &limits;
+    auto const start = std::chrono::steady_clock::now();
+    auto const isSolved = dlx.Solve(pieceCounts, placedPieces);
+    std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - start;
+    result.seconds = duration.count();
+    result.nodeCount = dlx.nodeCount;
+    if(isSolved) {
+      report();
+    } else if(dlx.isStopped) {
+      NoteStop(limits, sink, result);
+    }
+    return isSolved;
+  }
+
+  typename SolverType::Task task{
+    typename SolverType::BoardType(puzzle.boardWidth, puzzle.boardHeight),
+    BlackList(puzzle.boardWidth * puzzle.boardHeight, placementTable.orientationCount),
+    pieceCounts,
+    static_cast<unsigned int>(pieces.size()),
+    placedPieces,
+    ConnectedComponentLabeler<Mask>(board),
+    0,
+    0
+  };
+
+  SolverType solver(board, placementTable, isExactCover);
+  solver.isCounting = (puzzle.solutions != Puzzle::Solutions::First);
+  solver.limits = &limits;
+
+  // a stopped search resumes on a single thread, skipping the branches
+  // on the path that were searched before
+  auto const threadCount = (puzzle.resume ? 1 : puzzle.threadCount);
+  std::vector<typename SolverType::Step> resumePath;
+  if(puzzle.resume) {
+    for(auto &&step : puzzle.resume->path) {
+      resumePath.push_back(typename SolverType::Step{step.branch, step.placement});
+    }
+    solver.resumePath = &resumePath;
+  }
+
+  // branch on the placements filling a single block, if asked for
+  std::unique_ptr<CoveringTable<Mask>> coveringTable;
+  if(isExactCover && (puzzle.branching != Puzzle::Branching::SmallestRegion)) {
+    auto const isFirstEmpty = (puzzle.branching == Puzzle::Branching::FirstEmpty);
+    coveringTable.reset(new CoveringTable<Mask>(board, placementTable, isFirstEmpty));
+    solver.coveringTable = coveringTable.get();
+    solver.branching = (isFirstEmpty ?
+      SolverType::Branching::FirstEmpty :
+      SolverType::Branching::FewestCandidates);
+  }
+  solver.stats.isEnabled = puzzle.isCollectingStats;
+
+  // look up which pieces may fill the small regions
+  std::unique_ptr<TileabilityTable<Mask>> tileabilityTable;
+  if(isExactCover && puzzle.smallRegionBlockCount) {
+    tileabilityTable.reset(new TileabilityTable<Mask>(board, placementTable, puzzle.smallRegionBlockCount));
+    solver.pruner.tileabilityTable = tileabilityTable.get();
+  }
+
+  // solutions found when counting only go to the sink if asked for,
+  // arrangements not covering the board always do
+  std::unique_ptr<SinkAdapter<Mask, Width, Height>> sinkAdapter;
+  if(sink && (!isExactCover || (puzzle.solutions == Puzzle::Solutions::All))) {
+    sinkAdapter.reset(new SinkAdapter<Mask, Width, Height>(*sink, placementTable, puzzle.boardWidth));
+    solver.sink = sinkAdapter.get();
+  }
+
+  // search only one of each set of symmetric solutions
+  Symmetries<Mask> const symmetries(board, placementTable, pieceCounts);
+  if(isExactCover) {
+    solver.symmetries = &symmetries;
+    result.symmetryCount = symmetries.GetCount();
+  }
+
+  // skip states that failed before; only a single solver searching for
+  // the first solution has searched all branches that were skipped there
+  std::unique_ptr<TranspositionTable<Mask>> transpositionTable;
+  if(isExactCover &&
+     !solver.isCounting &&
+     (threadCount == 1) &&
+     puzzle.transpositionTableMegabytes) {
+    transpositionTable.reset(new TranspositionTable<Mask>(
+      placementTable, pieceCounts, puzzle.transpositionTableMegabytes << 20));
+    solver.transpositionTable = transpositionTable.get();
+    task.hash = transpositionTable->Hash(pieceCounts);
+  }
+
+  auto const start = std::chrono::steady_clock::now();
+  bool isSolved;
+  if(threadCount > 1) {
+    ParallelSolver<Mask, Width, Height> parallelSolver(solver, threadCount);
+    isSolved = parallelSolver.Solve(std::move(task), placedPieces);
+    parallelSolver.Accumulate(solver);
+  } else {
+#ifdef DEBUG_ALLOCATIONS
+    solver.Prepare(task);
+    auto const firstAllocationCount = allocationCount.load();
+#endif
+    isSolved = solver.Solve(task);
+#ifdef DEBUG_ALLOCATIONS
+    // expected to be 0, except for passing solutions to the sink
+    std::cout << "Solver: " << allocationCount - firstAllocationCount
+      << " heap allocations" << std::endl;
+#endif
+    placedPieces = task.placedPieces;
+  }
+  std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - start;
+  result.seconds = duration.count();
+  result.nodeCount = solver.nodeCount;
+  result.solutionCount = solver.solutionCount;
+  result.canonicalSolutionCount = solver.canonicalSolutionCount;
+  if(puzzle.resume) {
+    // the nodes on the path are searched again
+    result.seconds += puzzle.resume->seconds;
+    result.nodeCount += puzzle.resume->nodeCount - puzzle.resume->path.size();
+    result.solutionCount += puzzle.resume->solutionCount;
+    result.canonicalSolutionCount += puzzle.resume->canonicalSolutionCount;
+  }
+
+  if(puzzle.isCollectingStats) {
+    result.stats = solver.stats;
+    for(size_t reason = 0; reason < Pruner<Mask>::ReasonCount; ++reason) {
+      result.prunedCounts.emplace_back(
+        Pruner<Mask>::ReasonName(static_cast<typename Pruner<Mask>::Reason>(reason)),
+        solver.pruner.prunedCounts[reason]);
+    }
+    result.prunedCounts.emplace_back(
+      "transposition", (transpositionTable ? transpositionTable->hitCount : 0));
+    if(transpositionTable) {
+      result.transpositionCounts.emplace_back("hits", transpositionTable->hitCount);
+      result.transpositionCounts.emplace_back("misses", transpositionTable->missCount);
+      result.transpositionCounts.emplace_back("stores", transpositionTable->storeCount);
+    }
+  }
+
+  if(limits.IsReached() && (solver.isCounting || !isSolved)) {
+    NoteStop(limits, sink, result);
+    if(threadCount == 1) {
+      for(auto &&step : solver.GetStopPath()) {
+        result.checkpoint.path.push_back(Checkpoint::Step{step.branch, step.placement});
+      }
+      result.checkpoint.nodeCount = result.nodeCount;
+      result.checkpoint.solutionCount = result.solutionCount;
+      result.checkpoint.canonicalSolutionCount = result.canonicalSolutionCount;
+      result.checkpoint.seconds = result.seconds;
+      result.isResumable = true;
+    }
+    return false;
+  } else if(!isExactCover) {
+    // the search only stops early at arrangements not covering the board
+    isSolved = false;
+  } else if(solver.isCounting) {
+    // a solution the search stopped at has been passed on already
+    if(isSolved) {
+      result.placements = GetPlacements(placementTable, puzzle.boardWidth, placedPieces);
+    }
+    // including those found before a resume
+    isSolved = (result.solutionCount > 0);
+  } else if(isSolved) {
+    report();
+  }
+
+  return isSolved;
+}
+
+using SolveFunction = bool (*)(Puzzle const &,
+                              Puzzle::Engine,
+                              std::vector<Piece> const &,
+                              bool,
+                              SolutionSink *,
+                              Result &);
+
+// the narrowest board mask type for a number of blocks
+template<size_t BlockCount>
+using MaskFor = typename std::conditional<(BlockCount <= BitBoard<1>::bitCount), BitBoard<1>,
+  typename std::conditional<(BlockCount <= BitBoard<2>::bitCount), BitBoard<2>,
+  typename std::conditional<(BlockCount <= BitBoard<4>::bitCount), BitBoard<4>, BitBoard<8>>::type>::type>::type;
+
+template<size_t Width, size_t Height>
+struct Specialization {
+  static bool Run(Puzzle const &puzzle,
+                  Puzzle::Engine engine,
+                  std::vector<Piece> const &pieces,
+                  bool isExactCover,
+                  SolutionSink *sink,
+                  Result &result) {
+    return Solve<MaskFor<Width * Height>, Width, Height>(
+      puzzle, engine, pieces, isExactCover, sink, result);
+  }
+};
+
+// the solver specialized for the board size, if any
+SolveFunction GetSpecialization(size_t width, size_t height) {
+  // the board sizes of the game, 4 to 10 blocks by 10 and 8 blocks
+  static struct {
+    size_t width;
+    size_t height;
+    SolveFunction solve;
+  } const specializations[] = {
+    {4, 10, &Specialization<4, 10>::Run},
+    {5, 10, &Specialization<5, 10>::Run},
+    {6, 10, &Specialization<6, 10>::Run},
+    {7, 10, &Specialization<7, 10>::Run},
+    {8, 10, &Specialization<8, 10>::Run},
+    {9, 10, &Specialization<9, 10>::Run},
+    {10, 10, &Specialization<10, 10>::Run},
+    {10, 4, &Specialization<10, 4>::Run},
+    {10, 5, &Specialization<10, 5>::Run},
+    {10, 6, &Specialization<10, 6>::Run},
+    {10, 7, &Specialization<10, 7>::Run},
+    {10, 8, &Specialization<10, 8>::Run},
+    {10, 9, &Specialization<10, 9>::Run},
+    {4, 8, &Specialization<4, 8>::Run},
+    {5, 8, &Specialization<5, 8>::Run},
+    {6, 8, &Specialization<6, 8>::Run},
+    {7, 8, &Specialization<7, 8>::Run},
+    {8, 8, &Specialization<8, 8>::Run},
+    {8, 4, &Specialization<8, 4>::Run},
+    {8, 5, &Specialization<8, 5>::Run},
+    {8, 6, &Specialization<8, 6>::Run},
+    {8, 7, &Specialization<8, 7>::Run},
+  };
+  for(auto &&specialization : specializations) {
+    if((specialization.width == width) && (specialization.height == height)) {
+      return specialization.solve;
+    }
+  }
+  return nullptr;
+}
+
+// whether the piece's blocks are connected by their edges,
+// as the pruning by region and branching on regions assume
+bool IsConnected(Piece const &piece) {
+  std::vector<std::pair<size_t, size_t>> blocks;
+  std::vector<std::pair<size_t, size_t>> reached;
+  for(size_t y = 0; y < piece.sizeOf<1>(); ++y) {
+    for(size_t x = 0; x < piece.sizeOf<0>(); ++x) {
+      if(!piece.IsBlockEmpty(x, y)) {
+        blocks.emplace_back(x, y);
+      }
+    }
+  }
+  if(blocks.empty()) {
+    return true;
+  }
+
+  reached.push_back(blocks.front());
+  for(size_t i = 0; i < reached.size(); ++i) {
+    for(auto &&block : blocks) {
+      auto const distance =
+        (block.first > reached[i].first ? block.first - reached[i].first : reached[i].first - block.first) +
+        (block.second > reached[i].second ? block.second - reached[i].second : reached[i].second - block.second);
+      if((distance == 1) && (std::find(begin(reached), end(reached), block) == end(reached))) {
+        reached.push_back(block);
+      }
+    }
+  }
+  return (reached.size() == blocks.size());
+}
+
+} // unnamed namespace
+
+std::vector<Puzzle::Shape> ReadShapes(std::istream &is) {
+  std::vector<Puzzle::Shape> shapes;
+  bool isInShape = false;
+  for(std::string line; std::getline(is, line);) {
+    if(!line.empty() && (line.back() == '\r')) {
+      line.pop_back();
+    }
+
+    if(line.find_first_not_of(" \t") == std::string::npos) {
+      isInShape = false;
+    } else if(isInShape) {
+      shapes.back().rows.push_back(line);
+    } else if(line[0] != '#') {
+      std::istringstream iss(line);
+      std::string name;
+      std::string option;
+      iss >> name >> option;
+      if((name.size() != 1) || !std::isupper(static_cast<unsigned char>(name[0]))) {
+        throw std::invalid_argument("Invalid shape name: '" + name + "'");
+      } else if(!option.empty() && (option != "mirror")) {
+        throw std::invalid_argument("Invalid shape option: '" + option + "'");
+      } else if(std::any_of(begin(shapes), end(shapes),
+                  [&](Puzzle::Shape const &shape) -> bool {
+                    return (shape.name == name[0]);
+                  })) {
+        throw std::invalid_argument("Shape defined twice: '" + name + "'");
+      }
+      shapes.push_back(Puzzle::Shape{name[0], {}, !option.empty(), 0});
+      isInShape = true;
+    }
+  }
+
+  for(auto &&shape : shapes) {
+    // check the rows
+    if(!IsConnected(Piece::Create(0, shape.name, shape.rows, shape.isMirrorable))) {
+      throw std::invalid_argument("Shape not connected: '" + std::string(1, shape.name) + "'");
+    }
+  }
+  return shapes;
+}
+
+void WriteCheckpoint(std::ostream &os, Checkpoint const &checkpoint) {
+  os << "nodes " << checkpoint.nodeCount << "\n"
+    << "solutions " << checkpoint.solutionCount << " " << checkpoint.canonicalSolutionCount << "\n"
+    << "seconds " << std::setprecision(17) << checkpoint.seconds << "\n"
+    << "path";
+  for(auto &&step : checkpoint.path) {
+    os << " " << step.branch << ":" << step.placement;
+  }
+  os << "\n";
+}
+
+Checkpoint ReadCheckpoint(std::istream &is) {
+  Checkpoint checkpoint;
+  std::string key;
+  char colon;
+  if(!(is >> key) || (key != "nodes") || !(is >> checkpoint.nodeCount) ||
+     !(is >> key) || (key != "solutions") ||
+     !(is >> checkpoint.solutionCount >> checkpoint.canonicalSolutionCount) ||
+     !(is >> key) || (key != "seconds") || !(is >> checkpoint.seconds) ||
+     !(is >> key) || (key != "path")) {
+    throw std::invalid_argument("Invalid checkpoint");
+  }
+
+  std::string line;
+  std::getline(is, line);
+  std::istringstream iss(line);
+  for(Checkpoint::Step step; iss >> step.branch;) {
+    if(!(iss >> colon >> step.placement) || (colon != ':')) {
+      throw std::invalid_argument("Invalid checkpoint path");
+    }
+    checkpoint.path.push_back(step);
+  }
+  if(!iss.eof()) {
+    throw std::invalid_argument("Invalid checkpoint path");
+  }
+  return checkpoint;
+}
+
+Result SolvePuzzle(Puzzle const &puzzle, SolutionSink *sink) {
+  Result result;
+
+  // create Pieces
+  std::vector<Piece> pieces;
+  for(unsigned int i = 0; i < puzzle.piecesCountI; ++i) {
+    pieces.push_back(Piece::CreateI(static_cast<unsigned int>(pieces.size())));
+  }
+  for(unsigned int i = 0; i < puzzle.piecesCountL; ++i) {
+    pieces.push_back(Piece::CreateL(static_cast<unsigned int>(pieces.size())));
+  }
+  for(unsigned int i = 0; i < puzzle.piecesCountJ; ++i) {
+    pieces.push_back(Piece::CreateJ(static_cast<unsigned int>(pieces.size())));
+  }
+  for(unsigned int i = 0; i < puzzle.piecesCountT; ++i) {
+    pieces.push_back(Piece::CreateT(static_cast<unsigned int>(pieces.size())));
+  }
+  for(unsigned int i = 0; i < puzzle.piecesCountZ; ++i) {
+    pieces.push_back(Piece::CreateZ(static_cast<unsigned int>(pieces.size())));
+  }
+  for(unsigned int i = 0; i < puzzle.piecesCountS; ++i) {
+    pieces.push_back(Piece::CreateS(static_cast<unsigned int>(pieces.size())));
+  }
+  for(unsigned int i = 0; i < puzzle.piecesCountO; ++i) {
+    pieces.push_back(Piece::CreateO(static_cast<unsigned int>(pieces.size())));
+  }
+  std::string duplicateShapes;
+  for(auto &&shape : puzzle.shapes) {
+    if(std::any_of(begin(pieces), end(pieces),
+        [&](Piece const &piece) -> bool {
+          return (std::toupper(piece.type.shape) == shape.name);
+        })) {
+      duplicateShapes += shape.name;
+    }
+    for(unsigned int i = 0; i < shape.count; ++i) {
+      pieces.push_back(Piece::Create(
+        static_cast<unsigned int>(pieces.size()), shape.name, shape.rows, shape.isMirrorable));
+    }
+  }
+
+  auto const note = [&](std::string const &text) {
+    Note(sink, result, text);
+  };
+
+  auto const expectedPiecesBlockCount = puzzle.boardWidth * puzzle.boardHeight;
+  auto const receivedPiecesBlockCount = std::accumulate(
+    begin(pieces), end(pieces), static_cast<unsigned int>(0),
+    [](unsigned int sum, Piece const &piece) -> unsigned int {
+      return sum + piece.GetBlockCount();
+    });
+  if(!duplicateShapes.empty()) {
+    result.status = Result::Status::Invalid;
+    note("Shapes given twice: '" + duplicateShapes + "'");
+  } else if(receivedPiecesBlockCount > expectedPiecesBlockCount) {
+    note("Not solvable (too many pieces)");
+  } else if(expectedPiecesBlockCount > BitBoard<8>::bitCount) {
+    result.status = Result::Status::Invalid;
+    note("Board too large (at most " + std::to_string(BitBoard<8>::bitCount) + " blocks supported)");
+  } else {
+    auto engine = puzzle.engine;
+    if(receivedPiecesBlockCount < expectedPiecesBlockCount) {
+      note("Multiple solutions possible (too few pieces)");
+      if(engine == Puzzle::Engine::DancingLinks) {
+        note("Using search engine (dlx requires exact coverage)");
+        engine = Puzzle::Engine::Search;
+      }
+    } else if((puzzle.solutions != Puzzle::Solutions::First) &&
+              (engine == Puzzle::Engine::DancingLinks)) {
+      note("Using search engine (dlx does not count solutions)");
+      engine = Puzzle::Engine::Search;
+    }
+    if(puzzle.resume) {
+      if(engine == Puzzle::Engine::DancingLinks) {
+        note("Using search engine (dlx cannot resume)");
+        engine = Puzzle::Engine::Search;
+      } else if(puzzle.threadCount > 1) {
+        note("Resuming on a single thread");
+      }
+    }
+
+    auto const isExactCover = (receivedPiecesBlockCount == expectedPiecesBlockCount);
+
+    // use a solver specialized for the board size if there is one,
+    // or else a single-word board mask where possible
+    bool isSolved;
+    try {
+      if(auto const solve = GetSpecialization(puzzle.boardWidth, puzzle.boardHeight)) {
+        isSolved = solve(puzzle, engine, pieces, isExactCover, sink, result);
+      } else if(expectedPiecesBlockCount <= BitBoard<1>::bitCount) {
+        isSolved = Solve<BitBoard<1>, 0, 0>(puzzle, engine, pieces, isExactCover, sink, result);
+      } else if(expectedPiecesBlockCount <= BitBoard<2>::bitCount) {
+        isSolved = Solve<BitBoard<2>, 0, 0>(puzzle, engine, pieces, isExactCover, sink, result);
+      } else if(expectedPiecesBlockCount <= BitBoard<4>::bitCount) {
+        isSolved = Solve<BitBoard<4>, 0, 0>(puzzle, engine, pieces, isExactCover, sink, result);
+      } else {
+        isSolved = Solve<BitBoard<8>, 0, 0>(puzzle, engine, pieces, isExactCover, sink, result);
+      }
+    }
+    catch(std::invalid_argument const &e) {
+      // a checkpoint of another puzzle
+      result.status = Result::Status::Invalid;
+      note(e.what());
+      return result;
+    }
+    if(isSolved) {
+      result.status = Result::Status::Solved;
+    } else if(result.status != Result::Status::Unknown) {
+      note("No exact solution found");
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "stats.h"
+
+#include <atomic>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// where a search stopped before it was complete, to resume it from there;
+// only the search engine on a single thread is resumable
+struct Checkpoint {
+  struct Step {
+    size_t branch; // number of branches taken at its node before
+    size_t placement; // placement number, to check when resuming
+  };
+
+  std::vector<Step> path; // from the empty board to the node to search next
+  unsigned long long nodeCount; // counts of the search up to the stop
+  unsigned long long solutionCount;
+  unsigned long long canonicalSolutionCount;
+  double seconds;
+
+  Checkpoint()
+    : nodeCount(0)
+    , solutionCount(0)
+    , canonicalSolutionCount(0)
+    , seconds(0.0) {
+  }
+};
+
+// a puzzle to solve and how to search for its solutions
+struct Puzzle {
+  enum class Engine {
+    Search,
+    DancingLinks
+  };
+
+  // which placements the search tries at each step
+  enum class Branching {
+    SmallestRegion, // all that fit into the smallest region of empty blocks
+    FirstEmpty, // those filling the first empty block in row-major order
+    FewestCandidates // those filling the block of the smallest region that fewest fit
+  };
+
+  enum class Solutions {
+    First,
+    Count, // count all solutions
+    All    // count all solutions and pass them to the sink
+  };
+
+  // pieces of a shape other than the tetrominoes
+  struct Shape {
+    char name; // an uppercase letter
+    std::vector<std::string> rows; // '#' for blocks, '.' or ' ' for empty blocks
+    bool isMirrorable; // may be flipped over, else its mirror image is another shape
+    unsigned int count;
+  };
+
+  size_t boardWidth;
+  size_t boardHeight;
+  unsigned int piecesCountI;
+  unsigned int piecesCountL;
+  unsigned int piecesCountJ;
+  unsigned int piecesCountT;
+  unsigned int piecesCountZ;
+  unsigned int piecesCountS;
+  unsigned int piecesCountO;
+  std::vector<Shape> shapes; // names must differ from the tetrominoes in use
+  Engine engine;
+  Branching branching; // of the search engine; without exact cover, always the smallest region
+  unsigned int threadCount;
+  Solutions solutions;
+  size_t transpositionTableMegabytes; // 0 to disable
+  size_t smallRegionBlockCount; // largest region looked up as fillable or not, 0 to disable
+  bool isCollectingStats;
+  double timeoutSeconds; // 0 for none
+  unsigned long long maxNodeCount; // 0 for none, checked every 1024 nodes
+  std::atomic<bool> const *stopRequest; // optional, to stop the search, e.g. from a signal handler
+  Checkpoint const *resume; // optional, of the same puzzle
+
+  Puzzle()
+    : boardWidth(0)
+    , boardHeight(0)
+    , piecesCountI(0)
+    , piecesCountL(0)
+    , piecesCountJ(0)
+    , piecesCountT(0)
+    , piecesCountZ(0)
+    , piecesCountS(0)
+    , piecesCountO(0)
+    , engine(Engine::Search)
+    , branching(Branching::FewestCandidates)
+    , threadCount(1)
+    , solutions(Solutions::First)
+    , transpositionTableMegabytes(4)
+    , smallRegionBlockCount(8)
+    , isCollectingStats(false)
+    , timeoutSeconds(0.0)
+    , maxNodeCount(0)
+    , stopRequest(nullptr)
+    , resume(nullptr) {
+  }
+};
+
+// outcome of a puzzle
+struct Result {
+  enum class Status {
+    Solved,
+    Unsolved,
+    Invalid,
+    Unknown // stopped before the search was complete
+  };
+
+  struct Placement {
+    char shape;
+    std::vector<std::pair<size_t, size_t>> blocks; // x and y per block
+  };
+
+  using Placements = std::vector<Placement>;
+
+  Status status;
+  std::string message; // notes about the puzzle
+  Placements placements; // of the solution, if any
+  unsigned long long nodeCount;
+  unsigned long long solutionCount; // when counting, symmetric ones included
+  unsigned long long canonicalSolutionCount; // when counting
+  size_t symmetryCount; // of the solutions counted as one, identity included
+  double seconds; // of the search
+  SearchStats stats; // if collected
+  std::vector<std::pair<char const *, unsigned long long>> prunedCounts; // per reason, if collected
+  std::vector<std::pair<char const *, unsigned long long>> transpositionCounts; // if collected and the table used
+  bool isResumable; // if stopped, whether the checkpoint is set
+  Checkpoint checkpoint; // counts included
+
+  Result()
+    : status(Status::Unsolved)
+    , nodeCount(0)
+    , solutionCount(0)
+    , canonicalSolutionCount(0)
+    , symmetryCount(1)
+    , seconds(0.0)
+    , isResumable(false) {
+  }
+};
+
+// receives what is found while solving, from the searching threads
+// but never from two of them at a time
+struct SolutionSink {
+  enum class Action {
+    Continue,
+    Stop
+  };
+
+  virtual ~SolutionSink() = default;
+
+  // a note about the puzzle, e.g. why it has no solution
+  virtual void Note(std::string const &text) = 0;
+
+  // the first solution or, when passing all, one of each set
+  // of symmetric solutions; if the pieces cannot cover the board,
+  // each arrangement of all pieces, which is not covering then
+  virtual Action Receive(Result::Placements const &placements, bool isCovering) = 0;
+};
+
+// read shapes with a count of 0 from a shape file, throws std::invalid_argument;
+// a shape is given by a line of its name, followed by 'mirror' if it may be
+// flipped over, and its rows; empty lines and lines starting with '#'
+// before a shape are skipped
+std::vector<Puzzle::Shape> ReadShapes(std::istream &is);
+
+// a checkpoint as text, to resume in another run
+void WriteCheckpoint(std::ostream &os, Checkpoint const &checkpoint);
+
+// read a checkpoint written before, throws std::invalid_argument
+Checkpoint ReadCheckpoint(std::istream &is);
+
+// create the pieces and solve the puzzle,
+// passing notes and solutions to the sink if given
+Result SolvePuzzle(Puzzle const &puzzle, SolutionSink *sink);
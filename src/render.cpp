@@ -0,0 +1,67 @@
+#include "render.h"
+
+#include "color.h"
+
+#include "hypervector.h"
+
+#include <sstream>
+
+std::string RenderAnsi(size_t boardWidth,
+                       size_t boardHeight,
+                       Result::Placements const &placements) {
+  hypervector<Color, 2> colors(boardWidth, boardHeight);
+  for(size_t i = 0; i < placements.size(); ++i) {
+    auto const color = Color::FromId(static_cast<unsigned int>(i));
+    for(auto &&block : placements[i].blocks) {
+      colors.at(block.first, block.second) = color;
+    }
+  }
+
+  std::ostringstream os;
+  os << colors;
+  return os.str();
+}
+
+std::string RenderPlain(size_t boardWidth,
+                        size_t boardHeight,
+                        Result::Placements const &placements) {
+  std::string rows(boardHeight * (boardWidth + 1), '.');
+  for(size_t y = 0; y < boardHeight; ++y) {
+    rows[y * (boardWidth + 1) + boardWidth] = '\n';
+  }
+  for(auto &&placement : placements) {
+    for(auto &&block : placement.blocks) {
+      rows[block.second * (boardWidth + 1) + block.first] = placement.shape;
+    }
+  }
+  if(!rows.empty()) {
+    rows.pop_back();
+  }
+  return rows;
+}
+
+std::string RenderJson(Result::Placements const &placements) {
+  std::ostringstream os;
+  os << "[";
+  for(size_t i = 0; i < placements.size(); ++i) {
+    auto &&placement = placements[i];
+    os << (i ? "," : "") << "{\"shape\":\"" << placement.shape << "\",\"blocks\":[";
+    for(size_t j = 0; j < placement.blocks.size(); ++j) {
+      os << (j ? "," : "") << "[" << placement.blocks[j].first << "," << placement.blocks[j].second << "]";
+    }
+    os << "]}";
+  }
+  os << "]";
+  return os.str();
+}
+
+std::string EscapeJson(std::string const &str) {
+  std::string ret;
+  for(auto c : str) {
+    if((c == '"') || (c == '\\')) {
+      ret += '\\';
+    }
+    ret += c;
+  }
+  return ret;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "puzzle.h"
+
+#include <cstddef>
+#include <string>
+
+// the solution as colored blocks for ANSI terminals, one color per piece
+std::string RenderAnsi(size_t boardWidth,
+                       size_t boardHeight,
+                       Result::Placements const &placements);
+
+// the solution as shape letters, with '.' for empty blocks
+std::string RenderPlain(size_t boardWidth,
+                        size_t boardHeight,
+                        Result::Placements const &placements);
+
+// the placements as a JSON array of shapes and block coordinates
+std::string RenderJson(Result::Placements const &placements);
+
+std::string EscapeJson(std::string const &str);
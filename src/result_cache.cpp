@@ -0,0 +1,214 @@
+#include "result_cache.h"
+
+#include "piece.h"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <sstream>
+
+namespace {
+
+using Blocks = std::vector<std::pair<int, int>>;
+
+Blocks GetBlocks(Piece const &piece) {
+  Blocks blocks;
+  for(size_t y = 0; y < piece.sizeOf<1>(); ++y) {
+    for(size_t x = 0; x < piece.sizeOf<0>(); ++x) {
+      if(!piece.IsBlockEmpty(x, y)) {
+        blocks.emplace_back(static_cast<int>(x), static_cast<int>(y));
+      }
+    }
+  }
+  return blocks;
+}
+
+// the blocks moved to the origin as text, in sorted order
+std::string Normalize(Blocks blocks) {
+  auto minX = blocks.front().first;
+  auto minY = blocks.front().second;
+  for(auto &&block : blocks) {
+    minX = std::min(minX, block.first);
+    minY = std::min(minY, block.second);
+  }
+  for(auto &&block : blocks) {
+    block.first -= minX;
+    block.second -= minY;
+  }
+  std::sort(begin(blocks), end(blocks));
+
+  std::ostringstream os;
+  for(size_t i = 0; i < blocks.size(); ++i) {
+    os << (i ? ";" : "") << blocks[i].first << "," << blocks[i].second;
+  }
+  return os.str();
+}
+
+// the same for all orientations a piece of the shape may be placed in
+std::string GetCanonicalBlocks(Blocks blocks, bool isMirrorable) {
+  std::string ret;
+  for(int mirror = 0; mirror < (isMirrorable ? 2 : 1); ++mirror) {
+    for(int rotation = 0; rotation < 4; ++rotation) {
+      auto const normalized = Normalize(blocks);
+      if(ret.empty() || (normalized < ret)) {
+        ret = normalized;
+      }
+      for(auto &&block : blocks) {
+        block = std::make_pair(block.second, -block.first);
+      }
+    }
+    for(auto &&block : blocks) {
+      block.first = -block.first;
+    }
+  }
+  return ret;
+}
+
+} // unnamed namespace
+
+bool ResultCache::Find(Puzzle const &puzzle, Result &result) {
+  auto form = GetForm(puzzle);
+  if(form.key.empty()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto const it = m_index.find(form.key);
+  if(it == end(m_index)) {
+    ++missCount;
+    return false;
+  }
+  ++hitCount;
+  m_entries.splice(begin(m_entries), m_entries, it->second);
+
+  auto &&entry = it->second->second;
+  result = entry.result;
+  result.nodeCount = 0;
+  result.seconds = 0.0;
+  result.message += (result.message.empty() ? "" : "; ") + std::string("Cached");
+
+  // letters of the puzzle's shapes, as many as it has pieces of them
+  for(size_t i = 0; i < result.placements.size(); ++i) {
+    auto &&placement = result.placements[i];
+    for(auto &&shape : form.shapes) {
+      if(shape.count && (shape.blocks == entry.shapes[i])) {
+        placement.shape = shape.name;
+        --shape.count;
+        break;
+      }
+    }
+    if(form.isTransposed) {
+      for(auto &&block : placement.blocks) {
+        std::swap(block.first, block.second);
+      }
+    }
+  }
+  return true;
+}
+
+void ResultCache::Store(Puzzle const &puzzle, Result const &result) {
+  if(!m_capacity ||
+     ((result.status != Result::Status::Solved) &&
+      (result.status != Result::Status::Unsolved))) {
+    return;
+  }
+  auto const form = GetForm(puzzle);
+  if(form.key.empty()) {
+    return;
+  }
+
+  Entry entry;
+  entry.result.status = result.status;
+  entry.result.message = result.message;
+  entry.result.placements = result.placements;
+  entry.result.solutionCount = result.solutionCount;
+  entry.result.canonicalSolutionCount = result.canonicalSolutionCount;
+  entry.result.symmetryCount = result.symmetryCount;
+  for(auto &&placement : entry.result.placements) {
+    for(auto &&shape : form.shapes) {
+      if(shape.name == placement.shape) {
+        entry.shapes.push_back(shape.blocks);
+        break;
+      }
+    }
+    if(form.isTransposed) {
+      for(auto &&block : placement.blocks) {
+        std::swap(block.first, block.second);
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto const it = m_index.find(form.key);
+  if(it != end(m_index)) {
+    it->second->second = std::move(entry);
+    m_entries.splice(begin(m_entries), m_entries, it->second);
+    return;
+  }
+  m_entries.emplace_front(form.key, std::move(entry));
+  m_index[form.key] = begin(m_entries);
+  if(m_entries.size() > m_capacity) {
+    m_index.erase(m_entries.back().first);
+    m_entries.pop_back();
+  }
+}
+
+ResultCache::Form ResultCache::GetForm(Puzzle const &puzzle) {
+  // the pieces per shape letter
+  std::vector<std::pair<Piece, unsigned int>> pieces;
+  auto const addTetromino = [&](Piece (*create)(unsigned int), unsigned int count) {
+    if(count) {
+      pieces.emplace_back(create(0), count);
+    }
+  };
+  addTetromino(&Piece::CreateI, puzzle.piecesCountI);
+  addTetromino(&Piece::CreateL, puzzle.piecesCountL);
+  addTetromino(&Piece::CreateJ, puzzle.piecesCountJ);
+  addTetromino(&Piece::CreateT, puzzle.piecesCountT);
+  addTetromino(&Piece::CreateZ, puzzle.piecesCountZ);
+  addTetromino(&Piece::CreateS, puzzle.piecesCountS);
+  addTetromino(&Piece::CreateO, puzzle.piecesCountO);
+  for(auto &&shape : puzzle.shapes) {
+    if(shape.count) {
+      pieces.emplace_back(Piece::Create(0, shape.name, shape.rows, shape.isMirrorable), shape.count);
+    }
+  }
+
+  Form forms[2];
+  for(int isTransposed = 0; isTransposed < 2; ++isTransposed) {
+    auto &&form = forms[isTransposed];
+    form.isTransposed = (isTransposed != 0);
+
+    // shapes of the same blocks count as one
+    std::map<std::string, unsigned int> counts;
+    for(auto &&piece : pieces) {
+      auto blocks = GetBlocks(piece.first);
+      if(isTransposed) {
+        for(auto &&block : blocks) {
+          std::swap(block.first, block.second);
+        }
+      }
+      auto const name = static_cast<char>(std::toupper(piece.first.type.shape));
+      if(std::any_of(begin(form.shapes), end(form.shapes),
+          [&](Form::Shape const &shape) -> bool {
+            return (shape.name == name);
+          })) {
+        // shapes given twice make an invalid puzzle
+        return Form{"", false, {}};
+      }
+      form.shapes.push_back(Form::Shape{
+        name, GetCanonicalBlocks(blocks, piece.first.isMirrorable), piece.second});
+      counts[form.shapes.back().blocks] += piece.second;
+    }
+
+    std::ostringstream key;
+    key << (isTransposed ? puzzle.boardHeight : puzzle.boardWidth) << "x"
+      << (isTransposed ? puzzle.boardWidth : puzzle.boardHeight)
+      << (puzzle.solutions == Puzzle::Solutions::First ? " first" : " count");
+    for(auto &&count : counts) {
+      key << " " << count.first << "*" << count.second;
+    }
+    form.key = key.str();
+  }
+  return (forms[1].key < forms[0].key ? forms[1] : forms[0]);
+}
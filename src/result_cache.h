@@ -0,0 +1,61 @@
+#pragma once
+
+#include "puzzle.h"
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// results of puzzles solved before, by a canonical form of the board size
+// and the pieces, so a puzzle on the transposed board with the mirrored
+// pieces shares the entry; the least recently used entry is dropped first;
+// safe to use from multiple threads
+struct ResultCache {
+  unsigned long long hitCount;
+  unsigned long long missCount;
+
+  explicit ResultCache(size_t capacity)
+    : hitCount(0)
+    , missCount(0)
+    , m_capacity(capacity) {
+  }
+
+  // the result of an equivalent puzzle with its placements in the puzzle's
+  // orientation, without search nodes or time; returns false if not cached
+  bool Find(Puzzle const &puzzle, Result &result);
+
+  // keep a result unless its search was not complete or the puzzle invalid
+  void Store(Puzzle const &puzzle, Result const &result);
+
+private:
+  // the shape letters of a puzzle with their shape in the canonical orientation
+  struct Form {
+    struct Shape {
+      char name;
+      std::string blocks; // of all orientations the one sorting first
+      unsigned int count;
+    };
+
+    std::string key;
+    bool isTransposed; // whether the canonical orientation transposes the board
+    std::vector<Shape> shapes;
+  };
+
+  struct Entry {
+    Result result; // placements in the canonical orientation
+    std::vector<std::string> shapes; // per placement, instead of its letter
+  };
+
+  using Entries = std::list<std::pair<std::string, Entry>>;
+
+  static Form GetForm(Puzzle const &puzzle);
+
+  size_t m_capacity;
+  Entries m_entries; // most recently used first
+  std::unordered_map<std::string, Entries::iterator> m_index;
+  std::mutex m_mutex;
+};
@@ -0,0 +1,168 @@
+#include "server.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#ifndef _WIN32
+# include <cerrno>
+# include <csignal>
+# include <cstring>
+# include <poll.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <sys/un.h>
+# include <unistd.h>
+#endif
+
+namespace {
+
+// whether the line is a request, empty lines and comments are skipped
+bool IsRequest(std::string &line) {
+  if(!line.empty() && (line.back() == '\r')) {
+    line.pop_back();
+  }
+  auto const first = line.find_first_not_of(" \t");
+  return ((first != std::string::npos) && (line[first] != '#'));
+}
+
+#ifndef _WIN32
+// wait for the file descriptor to be readable, polling for a stop request;
+// returns false when stopped
+bool WaitReadable(int fd, std::atomic<bool> const &stopRequest) {
+  while(!stopRequest) {
+    pollfd pfd{fd, POLLIN, 0};
+    auto const ret = poll(&pfd, 1, 200);
+    if(ret > 0) {
+      return true;
+    } else if((ret < 0) && (errno != EINTR)) {
+      return false;
+    }
+  }
+  return false;
+}
+
+// remove a socket file left at the path by a server before;
+// returns false if there is another kind of file
+bool RemoveSocket(std::string const &path) {
+  struct stat status;
+  if(lstat(path.c_str(), &status)) {
+    return (errno == ENOENT);
+  } else if(!S_ISSOCK(status.st_mode)) {
+    errno = EEXIST;
+    return false;
+  }
+  return !unlink(path.c_str());
+}
+
+// write all of the text, returns false if the connection failed
+bool WriteAll(int fd, std::string const &text) {
+  for(size_t written = 0; written < text.size();) {
+    auto const writeCount = write(fd, text.data() + written, text.size() - written);
+    if((writeCount < 0) && (errno == EINTR)) {
+      continue;
+    } else if(writeCount <= 0) {
+      return false;
+    }
+    written += static_cast<size_t>(writeCount);
+  }
+  return true;
+}
+
+// answer the lines of a connection until it is closed,
+// also by the client before reading all responses;
+// a last line without a line break is answered as well
+void ServeConnection(int fd, RequestHandler const &handler, std::atomic<bool> const &stopRequest) {
+  size_t lineNumber = 0;
+  std::string buffer;
+  char chunk[4096];
+  while(WaitReadable(fd, stopRequest)) {
+    auto const readCount = read(fd, chunk, sizeof(chunk));
+    if((readCount < 0) && (errno == EINTR)) {
+      continue;
+    } else if(readCount < 0) {
+      return;
+    }
+    auto const isEnd = (readCount == 0);
+    if(isEnd) {
+      if(buffer.empty()) {
+        return;
+      }
+      buffer += '\n';
+    } else {
+      buffer.append(chunk, static_cast<size_t>(readCount));
+    }
+
+    for(size_t end; (end = buffer.find('\n')) != std::string::npos;) {
+      auto line = buffer.substr(0, end);
+      buffer.erase(0, end + 1);
+      ++lineNumber;
+      if(IsRequest(line) && !WriteAll(fd, handler(lineNumber, line) + "\n")) {
+        return;
+      }
+    }
+    if(isEnd) {
+      return;
+    }
+  }
+}
+#endif
+
+} // unnamed namespace
+
+void ServeStream(std::istream &is,
+                 std::ostream &os,
+                 RequestHandler const &handler,
+                 std::atomic<bool> const &stopRequest) {
+  size_t lineNumber = 0;
+  for(std::string line; !stopRequest && std::getline(is, line);) {
+    ++lineNumber;
+    if(IsRequest(line)) {
+      os << handler(lineNumber, line) << std::endl;
+    }
+  }
+}
+
+#ifdef _WIN32
+void ServeSocket(std::string const &,
+                 RequestHandler const &,
+                 std::atomic<bool> const &) {
+  std::cerr << "Unix domain sockets are not supported, serve stdin with '--serve -'\n";
+  exit(EXIT_FAILURE);
+}
+#else
+void ServeSocket(std::string const &path,
+                 RequestHandler const &handler,
+                 std::atomic<bool> const &stopRequest) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if(path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path too long: '" << path << "'\n";
+    exit(EXIT_FAILURE);
+  }
+  std::strcpy(address.sun_path, path.c_str());
+
+  // a client closing its connection fails the write instead of
+  // raising SIGPIPE, which would end the server
+  std::signal(SIGPIPE, SIG_IGN);
+
+  auto const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if((fd < 0) ||
+     !RemoveSocket(path) ||
+     bind(fd, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) ||
+     listen(fd, 16)) {
+    std::cerr << "Failed to listen on socket '" << path << "': " << std::strerror(errno) << "\n";
+    exit(EXIT_FAILURE);
+  }
+
+  while(WaitReadable(fd, stopRequest)) {
+    auto const connection = accept(fd, nullptr, nullptr);
+    if(connection >= 0) {
+      ServeConnection(connection, handler, stopRequest);
+      close(connection);
+    }
+  }
+
+  close(fd);
+  RemoveSocket(path);
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+
+// answers a request line, returns the response line
+using RequestHandler = std::function<std::string(size_t lineNumber, std::string const &line)>;
+
+// answer the lines of the stream one at a time until it ends
+// or a stop is requested
+void ServeStream(std::istream &is,
+                 std::ostream &os,
+                 RequestHandler const &handler,
+                 std::atomic<bool> const &stopRequest);
+
+// answer the lines of the connections to a Unix domain socket at the path,
+// one connection at a time, until a stop is requested;
+// exits if the socket cannot be set up or is not supported
+void ServeSocket(std::string const &path,
+                 RequestHandler const &handler,
+                 std::atomic<bool> const &stopRequest);
@@ -0,0 +1,73 @@
+#include "simd.h"
+
+#if defined(SIMD_X86) && defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+namespace simd {
+
+namespace {
+
+bool IsAvx2Supported() {
+#if defined(SIMD_X86) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if(info[0] < 7) {
+    return false;
+  }
+  // the OS must save the AVX registers on context switches
+  __cpuid(info, 1);
+  bool const isOsSavingAvx = ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+    ((_xgetbv(0) & 0x6) == 0x6));
+  __cpuidex(info, 7, 0);
+  return (isOsSavingAvx && (info[1] & (1 << 5)));
+#elif defined(SIMD_X86) && defined(__GNUC__)
+  // may run before the static constructors of libgcc
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+Kernels GetKernels(Level level) {
+  switch(level) {
+  case Level::Avx2:
+    return GetAvx2Kernels();
+  case Level::Sse2:
+    return GetSse2Kernels();
+  default:
+    return Kernels{Level::Scalar, nullptr, nullptr};
+  }
+}
+
+} // unnamed namespace
+
+Kernels kernels = GetKernels(GetSupportedLevel());
+
+Level GetSupportedLevel() {
+#ifdef SIMD_X86
+  // every x86-64 CPU has SSE2
+  return (IsAvx2Supported() ? Level::Avx2 : Level::Sse2);
+#else
+  return Level::Scalar;
+#endif
+}
+
+void SetLevel(Level level) {
+  auto const supported = GetSupportedLevel();
+  kernels = GetKernels(level < supported ? level : supported);
+}
+
+char const *ToString(Level level) {
+  switch(level) {
+  case Level::Avx2:
+    return "avx2";
+  case Level::Sse2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
+
+} // namespace simd
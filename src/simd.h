@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+# define SIMD_X86
+#endif
+
+// kernels over multi-word board masks, chosen once at startup
+// by the features of the CPU; masks of fewer words and CPUs without
+// a matching instruction set use the portable word loops of BitBoard
+namespace simd {
+
+enum class Level {
+  Scalar,
+  Sse2,
+  Avx2
+};
+
+// word counts of the masks the kernels are built for;
+// narrower masks are faster without a call
+constexpr bool IsKernelWordCount(size_t wordCount) {
+  return ((wordCount == 4) || (wordCount == 8));
+}
+
+// bit i set for each of the count masks, at most 64, not intersecting other
+using DisjointKernel = uint64_t (*)(uint64_t const *masks,
+                                    size_t count,
+                                    uint64_t const *other,
+                                    size_t wordCount);
+
+// grow the region by horizontally and vertically adjacent blocks
+// within the given blocks until it stops growing; sizeX is at most 63
+using FillKernel = void (*)(uint64_t *region,
+                            uint64_t const *blocks,
+                            uint64_t const *notFirstColumn,
+                            uint64_t const *notLastColumn,
+                            size_t sizeX,
+                            size_t wordCount);
+
+// null kernels fall back to the word loops
+struct Kernels {
+  Level level;
+  DisjointKernel disjoint;
+  FillKernel fill;
+};
+
+extern Kernels kernels;
+
+// the best level the CPU supports
+Level GetSupportedLevel();
+
+// use the kernels of the level, capped to the supported level
+void SetLevel(Level level);
+
+char const *ToString(Level level);
+
+// per instruction set, null if not built for this architecture
+Kernels GetSse2Kernels();
+Kernels GetAvx2Kernels();
+
+} // namespace simd
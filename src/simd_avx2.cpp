@@ -0,0 +1,131 @@
+#include "simd.h"
+
+#ifdef SIMD_X86
+
+#include <immintrin.h>
+
+// built with AVX2 enabled, but only called if the CPU supports it
+namespace simd {
+
+namespace {
+
+// four words per vector
+template<size_t VectorCount>
+uint64_t Disjoint(uint64_t const *masks, size_t count, uint64_t const *other) {
+  __m256i others[VectorCount];
+  for(size_t v = 0; v < VectorCount; ++v) {
+    others[v] = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(other) + v);
+  }
+
+  uint64_t ret = 0;
+  for(size_t i = 0; i < count; ++i) {
+    auto const mask = reinterpret_cast<__m256i const *>(masks) + i * VectorCount;
+    int isDisjoint = _mm256_testz_si256(_mm256_loadu_si256(mask), others[0]);
+    for(size_t v = 1; v < VectorCount; ++v) {
+      isDisjoint &= _mm256_testz_si256(_mm256_loadu_si256(mask + v), others[v]);
+    }
+    ret |= (uint64_t(isDisjoint) << i);
+  }
+  return ret;
+}
+
+template<size_t VectorCount>
+void Fill(uint64_t *region,
+          uint64_t const *blocks,
+          uint64_t const *notFirstColumn,
+          uint64_t const *notLastColumn,
+          size_t sizeX) {
+  __m256i regions[VectorCount];
+  __m256i all[VectorCount]; // blocks to grow into vertically
+  __m256i lefts[VectorCount]; // blocks to grow into from the left
+  __m256i rights[VectorCount]; // blocks to grow into from the right
+  for(size_t v = 0; v < VectorCount; ++v) {
+    regions[v] = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(region) + v);
+    all[v] = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(blocks) + v);
+    lefts[v] = _mm256_and_si256(all[v],
+      _mm256_loadu_si256(reinterpret_cast<__m256i const *>(notFirstColumn) + v));
+    rights[v] = _mm256_and_si256(all[v],
+      _mm256_loadu_si256(reinterpret_cast<__m256i const *>(notLastColumn) + v));
+  }
+
+  auto const one = _mm_cvtsi32_si128(1);
+  auto const oneComplement = _mm_cvtsi32_si128(63);
+  auto const row = _mm_cvtsi32_si128(static_cast<int>(sizeX));
+  auto const rowComplement = _mm_cvtsi32_si128(static_cast<int>(64 - sizeX));
+  auto const zero = _mm256_setzero_si256();
+
+  // grown regions are stored at once, so later vectors grow from them early
+  for(bool isGrowing = true; isGrowing;) {
+    isGrowing = false;
+    for(size_t v = 0; v < VectorCount; ++v) {
+      auto const prev = (v > 0 ? regions[v - 1] : zero);
+      auto const next = (v + 1 < VectorCount ? regions[v + 1] : zero);
+      auto const cur = regions[v];
+      // the words one word lower and one word higher, across the lanes
+      auto const lower = _mm256_blend_epi32(
+        _mm256_permute4x64_epi64(cur, _MM_SHUFFLE(2, 1, 0, 0)),
+        _mm256_permute4x64_epi64(prev, _MM_SHUFFLE(3, 3, 3, 3)), 0x03);
+      auto const upper = _mm256_blend_epi32(
+        _mm256_permute4x64_epi64(cur, _MM_SHUFFLE(0, 3, 2, 1)),
+        _mm256_permute4x64_epi64(next, _MM_SHUFFLE(0, 0, 0, 0)), 0xC0);
+
+      auto const up1 = _mm256_or_si256(_mm256_sll_epi64(cur, one), _mm256_srl_epi64(lower, oneComplement));
+      auto const down1 = _mm256_or_si256(_mm256_srl_epi64(cur, one), _mm256_sll_epi64(upper, oneComplement));
+      auto const upRow = _mm256_or_si256(_mm256_sll_epi64(cur, row), _mm256_srl_epi64(lower, rowComplement));
+      auto const downRow = _mm256_or_si256(_mm256_srl_epi64(cur, row), _mm256_sll_epi64(upper, rowComplement));
+
+      auto const grown = _mm256_or_si256(
+        _mm256_or_si256(cur, _mm256_and_si256(up1, lefts[v])),
+        _mm256_or_si256(_mm256_and_si256(down1, rights[v]),
+                        _mm256_and_si256(_mm256_or_si256(upRow, downRow), all[v])));
+      // nothing added if all grown blocks have been in the region
+      if(!_mm256_testc_si256(cur, grown)) {
+        isGrowing = true;
+        regions[v] = grown;
+      }
+    }
+  }
+
+  for(size_t v = 0; v < VectorCount; ++v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(region) + v, regions[v]);
+  }
+}
+
+uint64_t DisjointAvx2(uint64_t const *masks, size_t count, uint64_t const *other, size_t wordCount) {
+  return (wordCount == 4 ?
+    Disjoint<1>(masks, count, other) :
+    Disjoint<2>(masks, count, other));
+}
+
+void FillAvx2(uint64_t *region,
+              uint64_t const *blocks,
+              uint64_t const *notFirstColumn,
+              uint64_t const *notLastColumn,
+              size_t sizeX,
+              size_t wordCount) {
+  if(wordCount == 4) {
+    Fill<1>(region, blocks, notFirstColumn, notLastColumn, sizeX);
+  } else {
+    Fill<2>(region, blocks, notFirstColumn, notLastColumn, sizeX);
+  }
+}
+
+} // unnamed namespace
+
+Kernels GetAvx2Kernels() {
+  return Kernels{Level::Avx2, &DisjointAvx2, &FillAvx2};
+}
+
+} // namespace simd
+
+#else
+
+namespace simd {
+
+Kernels GetAvx2Kernels() {
+  return Kernels{Level::Scalar, nullptr, nullptr};
+}
+
+} // namespace simd
+
+#endif
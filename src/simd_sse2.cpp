@@ -0,0 +1,127 @@
+#include "simd.h"
+
+#ifdef SIMD_X86
+
+#include <emmintrin.h>
+
+namespace simd {
+
+namespace {
+
+// two words per vector
+template<size_t VectorCount>
+uint64_t Disjoint(uint64_t const *masks, size_t count, uint64_t const *other) {
+  __m128i others[VectorCount];
+  for(size_t v = 0; v < VectorCount; ++v) {
+    others[v] = _mm_loadu_si128(reinterpret_cast<__m128i const *>(other) + v);
+  }
+
+  auto const zero = _mm_setzero_si128();
+  uint64_t ret = 0;
+  for(size_t i = 0; i < count; ++i) {
+    auto const mask = reinterpret_cast<__m128i const *>(masks) + i * VectorCount;
+    auto acc = _mm_and_si128(_mm_loadu_si128(mask), others[0]);
+    for(size_t v = 1; v < VectorCount; ++v) {
+      acc = _mm_or_si128(acc, _mm_and_si128(_mm_loadu_si128(mask + v), others[v]));
+    }
+    auto const isDisjoint = (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, zero)) == 0xFFFF);
+    ret |= (uint64_t(isDisjoint) << i);
+  }
+  return ret;
+}
+
+template<size_t VectorCount>
+void Fill(uint64_t *region,
+          uint64_t const *blocks,
+          uint64_t const *notFirstColumn,
+          uint64_t const *notLastColumn,
+          size_t sizeX) {
+  __m128i regions[VectorCount];
+  __m128i all[VectorCount]; // blocks to grow into vertically
+  __m128i lefts[VectorCount]; // blocks to grow into from the left
+  __m128i rights[VectorCount]; // blocks to grow into from the right
+  for(size_t v = 0; v < VectorCount; ++v) {
+    regions[v] = _mm_loadu_si128(reinterpret_cast<__m128i const *>(region) + v);
+    all[v] = _mm_loadu_si128(reinterpret_cast<__m128i const *>(blocks) + v);
+    lefts[v] = _mm_and_si128(all[v],
+      _mm_loadu_si128(reinterpret_cast<__m128i const *>(notFirstColumn) + v));
+    rights[v] = _mm_and_si128(all[v],
+      _mm_loadu_si128(reinterpret_cast<__m128i const *>(notLastColumn) + v));
+  }
+
+  auto const one = _mm_cvtsi32_si128(1);
+  auto const oneComplement = _mm_cvtsi32_si128(63);
+  auto const row = _mm_cvtsi32_si128(static_cast<int>(sizeX));
+  auto const rowComplement = _mm_cvtsi32_si128(static_cast<int>(64 - sizeX));
+  auto const zero = _mm_setzero_si128();
+
+  // grown regions are stored at once, so later vectors grow from them early
+  for(bool isGrowing = true; isGrowing;) {
+    isGrowing = false;
+    for(size_t v = 0; v < VectorCount; ++v) {
+      auto const prev = (v > 0 ? regions[v - 1] : zero);
+      auto const next = (v + 1 < VectorCount ? regions[v + 1] : zero);
+      auto const cur = regions[v];
+      // the words one word lower and one word higher
+      auto const lower = _mm_or_si128(_mm_slli_si128(cur, 8), _mm_srli_si128(prev, 8));
+      auto const upper = _mm_or_si128(_mm_srli_si128(cur, 8), _mm_slli_si128(next, 8));
+
+      auto const up1 = _mm_or_si128(_mm_sll_epi64(cur, one), _mm_srl_epi64(lower, oneComplement));
+      auto const down1 = _mm_or_si128(_mm_srl_epi64(cur, one), _mm_sll_epi64(upper, oneComplement));
+      auto const upRow = _mm_or_si128(_mm_sll_epi64(cur, row), _mm_srl_epi64(lower, rowComplement));
+      auto const downRow = _mm_or_si128(_mm_srl_epi64(cur, row), _mm_sll_epi64(upper, rowComplement));
+
+      auto const grown = _mm_or_si128(
+        _mm_or_si128(cur, _mm_and_si128(up1, lefts[v])),
+        _mm_or_si128(_mm_and_si128(down1, rights[v]),
+                     _mm_and_si128(_mm_or_si128(upRow, downRow), all[v])));
+      if(_mm_movemask_epi8(_mm_cmpeq_epi8(grown, cur)) != 0xFFFF) {
+        isGrowing = true;
+        regions[v] = grown;
+      }
+    }
+  }
+
+  for(size_t v = 0; v < VectorCount; ++v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(region) + v, regions[v]);
+  }
+}
+
+uint64_t DisjointSse2(uint64_t const *masks, size_t count, uint64_t const *other, size_t wordCount) {
+  return (wordCount == 4 ?
+    Disjoint<2>(masks, count, other) :
+    Disjoint<4>(masks, count, other));
+}
+
+void FillSse2(uint64_t *region,
+              uint64_t const *blocks,
+              uint64_t const *notFirstColumn,
+              uint64_t const *notLastColumn,
+              size_t sizeX,
+              size_t wordCount) {
+  if(wordCount == 4) {
+    Fill<2>(region, blocks, notFirstColumn, notLastColumn, sizeX);
+  } else {
+    Fill<4>(region, blocks, notFirstColumn, notLastColumn, sizeX);
+  }
+}
+
+} // unnamed namespace
+
+Kernels GetSse2Kernels() {
+  return Kernels{Level::Sse2, &DisjointSse2, &FillSse2};
+}
+
+} // namespace simd
+
+#else
+
+namespace simd {
+
+Kernels GetSse2Kernels() {
+  return Kernels{Level::Scalar, nullptr, nullptr};
+}
+
+} // namespace simd
+
+#endif
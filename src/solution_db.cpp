@@ -0,0 +1,371 @@
+#include "solution_db.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#ifdef _WIN32
+# define WIN32_LEAN_AND_MEAN
+# define NOMINMAX
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+// the file starts with the magic and the number of entries, followed by
+// the entries sorted by key and the placements of the solved puzzles;
+// numbers are little endian
+//   entry: key, status, 2 bytes padding, 4 bytes offset of the placements
+//   key: board width and height, number of I, L, J, T, Z, S and O pieces
+//   placement: shape letter and the 4 blocks' positions on the board
+namespace {
+
+char const magic[8] = {'T', 'P', 'S', 'D', 'B', '0', '0', '1'};
+
+enum : size_t {
+  headerSize = 16,
+  keySize = 9,
+  entrySize = 16,
+  placementSize = 5,
+  tetrominoCount = 7
+};
+
+enum : unsigned char {
+  statusUnsolved = 0,
+  statusSolved = 1
+};
+
+using Key = std::string;
+
+// the letter of the mirrored tetromino, as on the transposed board
+char Mirror(char shape) {
+  switch(shape) {
+  case 'L':
+    return 'J';
+  case 'J':
+    return 'L';
+  case 'Z':
+    return 'S';
+  case 'S':
+    return 'Z';
+  default:
+    return shape;
+  }
+}
+
+// the key of the puzzle or the equivalent one on the transposed board,
+// whichever sorts first; returns false unless the database may hold it
+bool GetKey(Puzzle const &puzzle, Key &key, bool &isTransposed) {
+  unsigned int const counts[tetrominoCount] = {
+    puzzle.piecesCountI, puzzle.piecesCountL, puzzle.piecesCountJ, puzzle.piecesCountT,
+    puzzle.piecesCountZ, puzzle.piecesCountS, puzzle.piecesCountO
+  };
+  auto const blockCount = puzzle.boardWidth * puzzle.boardHeight;
+  if(std::any_of(begin(puzzle.shapes), end(puzzle.shapes),
+       [](Puzzle::Shape const &shape) -> bool {
+         return (shape.count > 0);
+       }) ||
+     !blockCount ||
+     (blockCount > SolutionDatabase::maxBlockCount) ||
+     (puzzle.boardWidth > 255) ||
+     (puzzle.boardHeight > 255) ||
+     (std::accumulate(std::begin(counts), std::end(counts), size_t(0)) * 4 != blockCount)) {
+    return false;
+  }
+
+  // the counts are at most 64 each
+  Key own(keySize, '\0');
+  Key transposed(keySize, '\0');
+  own[0] = transposed[1] = static_cast<char>(puzzle.boardWidth);
+  own[1] = transposed[0] = static_cast<char>(puzzle.boardHeight);
+  char const shapes[tetrominoCount] = {'I', 'L', 'J', 'T', 'Z', 'S', 'O'};
+  for(size_t i = 0; i < tetrominoCount; ++i) {
+    own[2 + i] = static_cast<char>(counts[i]);
+    auto const mirrored = std::find(std::begin(shapes), std::end(shapes), Mirror(shapes[i]));
+    transposed[2 + (mirrored - std::begin(shapes))] = static_cast<char>(counts[i]);
+  }
+
+  // compared as unsigned bytes, as in the file
+  isTransposed = (std::memcmp(transposed.data(), own.data(), keySize) < 0);
+  key = (isTransposed ? transposed : own);
+  return true;
+}
+
+void WriteNumber(std::ostream &os, uint64_t number, size_t byteCount) {
+  for(size_t i = 0; i < byteCount; ++i) {
+    os.put(static_cast<char>((number >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t ReadNumber(unsigned char const *data, size_t byteCount) {
+  uint64_t number = 0;
+  for(size_t i = 0; i < byteCount; ++i) {
+    number |= (uint64_t(data[i]) << (8 * i));
+  }
+  return number;
+}
+
+} // unnamed namespace
+
+SolutionDatabase::Enumerator::Enumerator(size_t maxBlockCount)
+  : m_boardSizeIndex(0) {
+  // the narrower side first, transposed boards are left out
+  maxBlockCount = std::min<size_t>(maxBlockCount, SolutionDatabase::maxBlockCount);
+  for(size_t blockCount = 4; blockCount <= maxBlockCount; blockCount += 4) {
+    for(size_t width = 1; width * width <= blockCount; ++width) {
+      if(!(blockCount % width) && (blockCount / width <= 255)) {
+        m_boardSizes.emplace_back(width, blockCount / width);
+      }
+    }
+  }
+}
+
+bool SolutionDatabase::Enumerator::Next(Puzzle &puzzle) {
+  for(;;) {
+    if(m_boardSizeIndex == m_boardSizes.size()) {
+      return false;
+    }
+    auto const width = m_boardSizes[m_boardSizeIndex].first;
+    auto const height = m_boardSizes[m_boardSizeIndex].second;
+
+    // the counts in lexicographic order, from all O to all I pieces
+    if(m_counts.empty()) {
+      m_counts.assign(tetrominoCount, 0);
+      m_counts.back() = static_cast<unsigned int>(width * height / 4);
+    } else {
+      auto last = tetrominoCount - 1;
+      while(!m_counts[last]) {
+        --last;
+      }
+      if(!last) {
+        m_counts.clear();
+        ++m_boardSizeIndex;
+        continue;
+      }
+      auto const count = m_counts[last];
+      m_counts[last] = 0;
+      ++m_counts[last - 1];
+      m_counts.back() = count - 1;
+    }
+
+    puzzle.boardWidth = width;
+    puzzle.boardHeight = height;
+    puzzle.piecesCountI = m_counts[0];
+    puzzle.piecesCountL = m_counts[1];
+    puzzle.piecesCountJ = m_counts[2];
+    puzzle.piecesCountT = m_counts[3];
+    puzzle.piecesCountZ = m_counts[4];
+    puzzle.piecesCountS = m_counts[5];
+    puzzle.piecesCountO = m_counts[6];
+
+    // on a square board, one of each pair of mirrored piece counts
+    Key key;
+    bool isTransposed;
+    if(GetKey(puzzle, key, isTransposed) && !isTransposed) {
+      return true;
+    }
+  }
+}
+
+bool SolutionDatabase::Builder::Add(Puzzle const &puzzle, Result const &result) {
+  Key key;
+  bool isTransposed;
+  if(!GetKey(puzzle, key, isTransposed) ||
+     ((result.status != Result::Status::Solved) && (result.status != Result::Status::Unsolved))) {
+    return false;
+  }
+
+  auto record = key;
+  if(result.status == Result::Status::Unsolved) {
+    record += static_cast<char>(statusUnsolved);
+  } else {
+    record += static_cast<char>(statusSolved);
+    // positions on the board of the key's orientation
+    auto const width = static_cast<unsigned char>(key[0]);
+    if(result.placements.size() * 4 != puzzle.boardWidth * puzzle.boardHeight) {
+      return false;
+    }
+    for(auto &&placement : result.placements) {
+      if(placement.blocks.size() != 4) {
+        return false;
+      }
+      record += (isTransposed ? Mirror(placement.shape) : placement.shape);
+      for(auto &&block : placement.blocks) {
+        auto const x = (isTransposed ? block.second : block.first);
+        auto const y = (isTransposed ? block.first : block.second);
+        record += static_cast<char>(y * width + x);
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_records.push_back(std::move(record));
+  return true;
+}
+
+void SolutionDatabase::Builder::Write(std::ostream &os) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto const compareKeys = [](std::string const &lhs, std::string const &rhs) -> bool {
+    return (std::memcmp(lhs.data(), rhs.data(), keySize) < 0);
+  };
+  std::sort(begin(m_records), end(m_records), compareKeys);
+  m_records.erase(std::unique(begin(m_records), end(m_records),
+    [](std::string const &lhs, std::string const &rhs) -> bool {
+      return !std::memcmp(lhs.data(), rhs.data(), keySize);
+    }), end(m_records));
+
+  os.write(magic, sizeof(magic));
+  WriteNumber(os, m_records.size(), 8);
+  size_t offset = 0;
+  for(auto &&record : m_records) {
+    os.write(record.data(), keySize + 1);
+    WriteNumber(os, 0, 2);
+    WriteNumber(os, offset, 4);
+    offset += record.size() - keySize - 1;
+  }
+  for(auto &&record : m_records) {
+    os.write(record.data() + keySize + 1, static_cast<std::streamsize>(record.size() - keySize - 1));
+  }
+}
+
+SolutionDatabase::SolutionDatabase(std::string const &path)
+  : m_data(nullptr)
+  , m_dataSize(0)
+  , m_entryCount(0)
+  , m_mapping(nullptr)
+  , m_file(nullptr) {
+#ifdef _WIN32
+  auto const file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  LARGE_INTEGER size;
+  if((file == INVALID_HANDLE_VALUE) || !GetFileSizeEx(file, &size)) {
+    if(file != INVALID_HANDLE_VALUE) {
+      CloseHandle(file);
+    }
+    throw std::invalid_argument("Failed to open database file: '" + path + "'");
+  }
+  m_file = file;
+  m_dataSize = static_cast<size_t>(size.QuadPart);
+  if(m_dataSize) {
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(m_mapping) {
+      m_data = static_cast<unsigned char const *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+  }
+#else
+  auto const fd = open(path.c_str(), O_RDONLY);
+  struct stat status;
+  if((fd < 0) || fstat(fd, &status)) {
+    if(fd >= 0) {
+      close(fd);
+    }
+    throw std::invalid_argument("Failed to open database file: '" + path + "'");
+  }
+  m_dataSize = static_cast<size_t>(status.st_size);
+  if(m_dataSize) {
+    auto const data = mmap(nullptr, m_dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data != MAP_FAILED) {
+      m_data = static_cast<unsigned char const *>(data);
+    }
+  }
+  close(fd);
+#endif
+
+  if(!m_data ||
+     (m_dataSize < headerSize) ||
+     std::memcmp(m_data, magic, sizeof(magic))) {
+    Close();
+    throw std::invalid_argument("Invalid database file: '" + path + "'");
+  }
+  auto const entryCount = ReadNumber(m_data + sizeof(magic), 8);
+  if(entryCount > (m_dataSize - headerSize) / entrySize) {
+    Close();
+    throw std::invalid_argument("Invalid database file: '" + path + "'");
+  }
+  m_entryCount = static_cast<size_t>(entryCount);
+}
+
+SolutionDatabase::~SolutionDatabase() {
+  Close();
+}
+
+void SolutionDatabase::Close() {
+#ifdef _WIN32
+  if(m_data) {
+    UnmapViewOfFile(m_data);
+  }
+  if(m_mapping) {
+    CloseHandle(m_mapping);
+  }
+  if(m_file) {
+    CloseHandle(m_file);
+  }
+#else
+  if(m_data) {
+    munmap(const_cast<unsigned char *>(m_data), m_dataSize);
+  }
+#endif
+  m_data = nullptr;
+  m_mapping = nullptr;
+  m_file = nullptr;
+}
+
+bool SolutionDatabase::Find(Puzzle const &puzzle, Result &result) const {
+  Key key;
+  bool isTransposed;
+  if((puzzle.solutions != Puzzle::Solutions::First) || !GetKey(puzzle, key, isTransposed)) {
+    return false;
+  }
+
+  // binary search of the entries
+  auto const entries = m_data + headerSize;
+  size_t first = 0;
+  size_t count = m_entryCount;
+  while(count) {
+    auto const half = count / 2;
+    if(std::memcmp(entries + (first + half) * entrySize, key.data(), keySize) < 0) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  auto const entry = entries + first * entrySize;
+  if((first == m_entryCount) || std::memcmp(entry, key.data(), keySize)) {
+    return false;
+  }
+
+  Result found;
+  if(entry[keySize] == statusSolved) {
+    auto const placements = entries + m_entryCount * entrySize;
+    auto const offset = ReadNumber(entry + keySize + 3, 4);
+    auto const pieceCount = puzzle.boardWidth * puzzle.boardHeight / 4;
+    if(headerSize + m_entryCount * entrySize + offset + pieceCount * placementSize > m_dataSize) {
+      return false;
+    }
+
+    // back to the puzzle's orientation
+    auto const width = static_cast<unsigned char>(key[0]);
+    for(size_t i = 0; i < pieceCount; ++i) {
+      auto const placement = placements + offset + i * placementSize;
+      auto const shape = static_cast<char>(placement[0]);
+      found.placements.push_back(Result::Placement{isTransposed ? Mirror(shape) : shape, {}});
+      for(size_t block = 1; block < placementSize; ++block) {
+        size_t const x = placement[block] % width;
+        size_t const y = placement[block] / width;
+        found.placements.back().blocks.emplace_back(isTransposed ? y : x, isTransposed ? x : y);
+      }
+    }
+    found.status = Result::Status::Solved;
+    found.message = "From database";
+  } else {
+    found.message = "No exact solution found; From database";
+  }
+  result = std::move(found);
+  return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "puzzle.h"
+
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// a file of tetromino puzzles covering the board exactly, solved before,
+// sorted by board size and piece counts to be looked up in place;
+// of each pair of puzzles on transposed boards with mirrored pieces,
+// only one is kept
+struct SolutionDatabase {
+  enum : size_t {
+    maxBlockCount = 256 // block positions are stored in a byte
+  };
+
+  // enumerates the puzzles of a database, all piece counts
+  // per board size of up to a number of blocks
+  struct Enumerator {
+    explicit Enumerator(size_t maxBlockCount);
+
+    // set the board size and the piece counts of the next puzzle,
+    // returns false after the last one
+    bool Next(Puzzle &puzzle);
+
+  private:
+    std::vector<std::pair<size_t, size_t>> m_boardSizes; // width and height
+    size_t m_boardSizeIndex;
+    std::vector<unsigned int> m_counts; // per tetromino, empty before the board size's first
+  };
+
+  // collects the results of puzzles, safe to use from multiple threads
+  struct Builder {
+    // keep the result if the database holds the puzzle
+    // and its search was complete; returns whether it was kept
+    bool Add(Puzzle const &puzzle, Result const &result);
+
+    void Write(std::ostream &os);
+
+  private:
+    std::vector<std::string> m_records; // key, status and placements
+    std::mutex m_mutex;
+  };
+
+  // map the database file, throws std::invalid_argument
+  explicit SolutionDatabase(std::string const &path);
+  ~SolutionDatabase();
+
+  SolutionDatabase(SolutionDatabase const &) = delete;
+  SolutionDatabase &operator=(SolutionDatabase const &) = delete;
+
+  // the result of the puzzle or an equivalent one, without search nodes
+  // or time; returns false unless the database holds it and it is asked for
+  // the first solution
+  bool Find(Puzzle const &puzzle, Result &result) const;
+
+  size_t GetSize() const {
+    return m_entryCount;
+  }
+
+private:
+  void Close();
+
+  unsigned char const *m_data;
+  size_t m_dataSize;
+  size_t m_entryCount;
+  void *m_mapping; // handles of the mapping where needed
+  void *m_file;
+};
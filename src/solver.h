@@ -1,89 +1,570 @@
 #pragma once
 
+#include "blacklist.h"
 #include "board.h"
 #include "ccl.h"
+#include "limits.h"
 #include "piece.h"
-
-#include "hypervector.h"
+#include "placement.h"
+#include "pruning.h"
+#include "stats.h"
+#include "symmetry.h"
+#include "transposition.h"
 
 #include <algorithm>
-#include <iostream>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
+// searches a board of a size fixed at compile time
+// unless Width and Height are 0
+template<typename Mask, size_t Width = 0, size_t Height = 0>
 struct Solver {
-  using BlackList = hypervector<std::vector<Piece::Type>, 2>;
+  using BoardType = Board<Mask, Width, Height>;
+  using PlacedPieces = std::vector<PlacedPiece<Mask>>;
+
+  // search state of a node, to continue the search elsewhere
+  struct Task {
+    BoardType board;
+    BlackList blackList;
+    PieceCounts pieceCounts;
+    unsigned int piecesCount;
+    PlacedPieces placedPieces;
+    ConnectedComponentLabeler<Mask> ccl;
+    size_t firstShape;
+    uint64_t hash; // of the transposition table, if any
+  };
+
+  // hooks for searching in parallel with other solvers
+  struct Sharing {
+    virtual ~Sharing() = default;
+
+    // whether the search has ended elsewhere
+    virtual bool IsCancelled() const = 0;
+
+    // whether another solver waits for a task
+    virtual bool WantsTask() const = 0;
+
+    virtual void Share(Task task) = 0;
+  };
+
+  // receives what the search finds, from each searching thread
+  struct Sink {
+    virtual ~Sink() = default;
+
+    // a solution counted as canonical, or an arrangement of all pieces
+    // not covering the board; returns whether to search on
+    virtual bool Receive(PlacedPieces const &placedPieces, bool isCovering) = 0;
+  };
+
+  // a branch taken on the way to the node where the search stopped
+  struct Step {
+    size_t branch; // number of branches taken at its node before
+    size_t placement; // placement number, to check when resuming
+  };
+
+  // which placements to try at a node
+  enum class Branching {
+    SmallestRegion, // those inside the smallest region of empty blocks
+    FirstEmpty, // those filling the lowest empty block
+    FewestCandidates // those filling the block of the smallest region that fewest fit
+  };
+
+  Pruner<Mask> pruner;
+  Branching branching;
+  CoveringTable<Mask> const *coveringTable; // unless branching on the smallest region
+  Sharing *sharing; // optional
+  Symmetries<Mask> const *symmetries; // optional, to skip symmetric first placements
+  TranspositionTable<Mask> *transpositionTable; // optional, for a single solver of the first solution
+  bool isCounting; // continue the search after a solution
+  Sink *sink; // optional, for solutions when counting and partial arrangements
+  SearchLimits *limits; // optional, to stop before the search is complete
+  std::vector<Step> const *resumePath; // optional, of a single solver, to resume a stopped search
+  bool isStopped; // by the limits, before the search was complete
+  unsigned long long nodeCount;
+  unsigned long long solutionCount; // including symmetric ones
+  unsigned long long canonicalSolutionCount;
+  SearchStats stats;
+
+  Solver(Board<Mask> const &board,
+         PlacementTable<Mask> const &placementTable,
+         bool isExactCover)
+    : pruner(board, placementTable, isExactCover)
+    , branching(Branching::SmallestRegion)
+    , coveringTable(nullptr)
+    , sharing(nullptr)
+    , symmetries(nullptr)
+    , transpositionTable(nullptr)
+    , isCounting(false)
+    , sink(nullptr)
+    , limits(nullptr)
+    , resumePath(nullptr)
+    , isStopped(false)
+    , nodeCount(0)
+    , solutionCount(0)
+    , canonicalSolutionCount(0)
+    , m_placementTable(placementTable)
+    , m_uncheckedNodeCount(0)
+    , m_resumeDepth(noDepth)
+    , m_stopDepth(0) {
+  }
+
+  // add the other solver's counters
+  void Accumulate(Solver const &other) {
+    for(size_t reason = 0; reason < pruner.prunedCounts.size(); ++reason) {
+      pruner.prunedCounts[reason] += other.pruner.prunedCounts[reason];
+    }
+    nodeCount += other.nodeCount;
+    solutionCount += other.solutionCount;
+    canonicalSolutionCount += other.canonicalSolutionCount;
+    stats.Accumulate(other.stats);
+  }
+
+  // allocate the per-depth state for searching from the task's state,
+  // the search itself does not allocate unless it shares tasks
+  void Prepare(Task &task) {
+    m_labelers.assign(task.piecesCount + 1, task.ccl);
+    m_path.assign(task.piecesCount + 1, Step{0, 0});
+    task.placedPieces.reserve(task.placedPieces.size() + task.piecesCount);
+    m_blackListed.clear();
+    m_blackListed.reserve(m_placementTable.placementCount);
+    stats.Reserve(task.placedPieces.size() + task.piecesCount);
+  }
 
-  unsigned int pieceMinimumBlockCount;
+  bool Solve(Task &task) {
+    Prepare(task);
+    m_resumeDepth = ((resumePath && !resumePath->empty()) ? 0 : noDepth);
+    m_stopDepth = 0;
+    isStopped = (limits && limits->IsReached());
+    if(isStopped) {
+      return false;
+    }
+
+    SearchStats::Timer timer(stats.Time(stats.searchTime));
+    auto const isSolved = Solve(task.board,
+                                task.blackList,
+                                task.pieceCounts,
+                                task.piecesCount,
+                                task.placedPieces,
+                                0,
+                                task.firstShape,
+                                task.hash);
+    CheckResumed();
+    return isSolved;
+  }
 
-  Solver()
-    : pieceMinimumBlockCount(0) {
+  // the branches from the task's node to where the search stopped,
+  // to resume a single solver from there
+  std::vector<Step> GetStopPath() const {
+    return std::vector<Step>(begin(m_path), begin(m_path) + m_stopDepth);
   }
 
+private:
+  // where a branch is relative to the path being resumed
+  enum class Resume {
+    None, // not resuming at the node
+    Before, // searched before the search stopped
+    At // on the path, to be resumed beneath
+  };
+
+  static constexpr size_t noDepth = ~size_t(0);
+
   // recursive function performing depth-first tree search
-  // operates on its own copy of board and blacklist
-  // but shares pieces and modifies their order
-  bool Solve(Board board,
-             BlackList blackList,
-             std::vector<Piece>::iterator firstPiece,
-             std::vector<Piece>::iterator lastPiece) const {
-    auto const piecesCount = std::distance(firstPiece, lastPiece);
+  // inserts into the shared board and blacklist
+  // and relabels the board's empty blocks into the labeler of its depth,
+  // it shares the number of pieces yet to be inserted per shape
+  // and the pieces inserted so far as well;
+  // all of which are restored before returning unsuccessfully;
+  // branches once per shape, so pieces of the same shape
+  // are never tried one after another;
+  // shapes are tried in cyclic order starting with firstShape;
+  // when solved, placedPieces holds the solution;
+  // when counting, solutions are counted and the search goes on
+  // until the sink asks to stop, placedPieces then holds the last one;
+  // when branching on the smallest region, placements on the empty board
+  // with a symmetric image that is tried before them are skipped;
+  // states found unsolvable are looked up by their hash;
+  // stops at the limits, checked once per checkInterval nodes,
+  // and when resuming, skips the branches searched before the stop
+  bool Solve(BoardType &board,
+             BlackList &blackList,
+             PieceCounts &pieceCounts,
+             unsigned int piecesCount,
+             PlacedPieces &placedPieces,
+             size_t depth,
+             size_t firstShape,
+             uint64_t hash) {
+    if(limits &&
+       (++m_uncheckedNodeCount >= limits->checkInterval) &&
+       (m_resumeDepth == noDepth)) {
+      // not while resuming, the stop path would not include the resumed one
+      isStopped = limits->Check(m_uncheckedNodeCount);
+      m_uncheckedNodeCount = 0;
+      if(isStopped) {
+        m_stopDepth = depth;
+        return false;
+      }
+    }
+
+    auto const firstNodeCount = nodeCount++;
+    if(stats.IsCollecting()) {
+      ++stats.nodeCounts[placedPieces.size()];
+    }
     if(!piecesCount) {
       // all pieces have been placed
-      std::cout << board << "\n\n";
-      return board.IsSolved();
-    } else {
-#ifdef DEBUG_SOLVER_STEPS
-      static unsigned long long iterationCount = 0;
-      std::cout << board
-        << " Solver: pieces remaining " << piecesCount
-        << ", iteration " << iterationCount++ << "\n\n";
-#endif
+      if(!board.IsSolved()) {
+        return (sink && !sink->Receive(placedPieces, false));
+      } else if(!isCounting) {
+        return true;
+      }
+
+      // count each class of symmetric solutions once
+      auto const orbitSize = (symmetries ? symmetries->OrbitSize(placedPieces) : 1);
+      if(orbitSize) {
+        ++canonicalSolutionCount;
+        solutionCount += orbitSize;
+        if(sink && !sink->Receive(placedPieces, true)) {
+          return true;
+        }
+      }
+      return false;
     }
 
-    // determine the remaining board blocks,
+    // check the remaining board blocks,
     // especially the smallest, most restrictive remaining space
-    ConnectedComponentLabeler ccl(board);
-
-    bool isSolvable = (ccl.GetMinSize() >= pieceMinimumBlockCount);
+    auto &&ccl = m_labelers[depth];
+    bool isSolvable;
+    {
+      SearchStats::Timer timer(stats.Time(stats.pruningTime));
+      isSolvable = pruner.MaySolve(board, ccl, pieceCounts);
+    }
     if(!isSolvable) {
-#ifdef DEBUG_SOLVABLE_CHECK
-      std::cout << board << " Solver: unsolvable" << std::endl;
-#endif
       return false;
     }
 
-    auto const sub = ccl.GetMin();
-
-    for(ptrdiff_t piecesOrder = 0; piecesOrder < piecesCount; ++piecesOrder) {
-      auto piece = *firstPiece;
-      do {
-        for(size_t y = 0; y < sub.board.sizeOf<1>(); ++y) {
-          for(size_t x = 0; x < sub.board.sizeOf<0>(); ++x) {
-            if(sub.board.MayInsert(piece, x, y)) {
-              auto &&blackListEntry = blackList.at(x + sub.offsetX, y + sub.offsetY);
-              bool isBlackListed = (end(blackListEntry) != std::find(
-                begin(blackListEntry), end(blackListEntry), piece.type));
-              if(!isBlackListed) {
-                // next iteration with updated board and pieces list
-                if(Solve(board.Insert(piece, x + sub.offsetX, y + sub.offsetY),
-                         blackList,
-                         std::next(firstPiece),
-                         lastPiece)) {
+    // the same pieces inserted in a different order have failed before;
+    // any solution would have been found there or in a branch searched before
+    if(transpositionTable && transpositionTable->IsUnsolvable(hash)) {
+      return false;
+    }
+
+    if(coveringTable) {
+      return BranchOnBlock(board, blackList, pieceCounts, piecesCount, placedPieces,
+                           depth, firstShape, hash, firstNodeCount);
+    }
+
+    auto &&sub = ccl.GetMin();
+    auto const outsideSub = ~sub.region;
+    auto const isFirstPlacement = (symmetries && placedPieces.empty());
+    auto const blackListedCount = m_blackListed.size();
+    size_t branch = 0;
+
+    for(size_t shapeOrder = 0; shapeOrder < pieceCounts.size(); ++shapeOrder) {
+      auto const shapeIndex = (firstShape + shapeOrder) % pieceCounts.size();
+      auto &&count = pieceCounts[shapeIndex];
+      if(!count) {
+        continue;
+      }
+
+      for(auto &&orientation : m_placementTable.shapes[shapeIndex].orientations) {
+        if((orientation.sizeX > sub.sizeX) ||
+           (orientation.sizeY > sub.sizeY)) {
+          continue;
+        }
+
+        auto const endX = sub.offsetX + sub.sizeX - orientation.sizeX + 1;
+        for(size_t y = sub.offsetY; y + orientation.sizeY <= sub.offsetY + sub.sizeY; ++y) {
+          for(size_t firstX = sub.offsetX; firstX < endX; firstX += 64) {
+            // the piece must fit into the minimum-size component entirely,
+            // tested for the insert positions of a row at once
+            auto fits = Mask::Disjoint(&orientation.At(firstX, y),
+                                       std::min<size_t>(endX - firstX, 64),
+                                       outsideSub);
+            for(; fits; fits &= fits - 1) {
+              auto const x = firstX + bits::CountTrailingZeros(fits);
+              auto &&mask = orientation.At(x, y);
+              auto const blackListIndex = blackList.Index(board.Offset(x, y), orientation.index);
+              bool isBlackListed = blackList.Test(blackListIndex);
+              m_path[depth] = Step{branch++, orientation.IndexAt(x, y)};
+              if(GetResume(depth) == Resume::Before) {
+                // blacklisted as if searched again
+                if(!isBlackListed) {
+                  BlackListAt(blackList, blackListIndex);
+                }
+                continue;
+              }
+              if(stats.IsCollecting()) {
+                ++stats.triedCount;
+                stats.blackListHitCount += isBlackListed;
+              }
+              if(!isBlackListed &&
+                 isFirstPlacement &&
+                 !symmetries->IsCanonical(orientation.IndexAt(x, y))) {
+                // a symmetric placement has been tried before
+                BlackListAt(blackList, blackListIndex);
+                if(stats.IsCollecting()) {
+                  ++stats.symmetrySkipCount;
+                }
+              } else if(!isBlackListed) {
+                if(stats.IsCollecting()) {
+                  ++stats.acceptedCount;
+                }
+                if(Branch(board,
+                          blackList,
+                          pieceCounts,
+                          piecesCount,
+                          placedPieces,
+                          depth,
+                          hash,
+                          shapeIndex,
+                          mask,
+                          orientation.IndexAt(x, y))) {
                   return true;
-                } else {
-                  // do not try the same type in the same spot again, if we have multiple
-                  blackListEntry.push_back(piece.type);
+                }
+
+                // do not try the same type in the same spot again,
+                // a shared branch is searched elsewhere
+                BlackListAt(blackList, blackListIndex);
+
+                if(IsStopping()) {
+                  RestoreBlackList(blackList, blackListedCount);
+                  return false;
                 }
               }
             }
           }
         }
-      } while(piece.RotateRight()); // try again with this piece rotated
+      }
+    }
+
+    CheckResumed();
+    RestoreBlackList(blackList, blackListedCount);
+    if(transpositionTable) {
+      transpositionTable->StoreUnsolvable(hash, nodeCount - firstNodeCount);
+    }
+    return false;
+  }
+
+  // branch on the placements filling one empty block, which any solution
+  // fills with exactly one of them, so none is tried twice and
+  // there is nothing to blacklist; symmetric first placements are
+  // not skipped, symmetric solutions are only counted once nonetheless
+  bool BranchOnBlock(BoardType &board,
+                     BlackList &blackList,
+                     PieceCounts &pieceCounts,
+                     unsigned int piecesCount,
+                     PlacedPieces &placedPieces,
+                     size_t depth,
+                     size_t firstShape,
+                     uint64_t hash,
+                     unsigned long long firstNodeCount) {
+    auto const pos = (branching == Branching::FirstEmpty ?
+      board.Empty().First() :
+      GetFewestCandidatesBlock(board, m_labelers[depth].GetMin().region, pieceCounts));
+    size_t branch = 0;
+
+    for(size_t shapeOrder = 0; shapeOrder < pieceCounts.size(); ++shapeOrder) {
+      auto const shapeIndex = (firstShape + shapeOrder) % pieceCounts.size();
+      if(!pieceCounts[shapeIndex]) {
+        continue;
+      }
+
+      auto const end = coveringTable->End(pos, shapeIndex);
+      for(auto first = coveringTable->Begin(pos, shapeIndex); first < end; first += 64) {
+        auto fits = Mask::Disjoint(&coveringTable->masks[first],
+                                   std::min<size_t>(end - first, 64),
+                                   board.Occupied());
+        for(; fits; fits &= fits - 1) {
+          auto const index = first + bits::CountTrailingZeros(fits);
+          auto &&candidate = coveringTable->candidates[index];
+          auto const placementIndex = candidate.orientation->IndexAt(candidate.posX, candidate.posY);
+          m_path[depth] = Step{branch++, placementIndex};
+          if(GetResume(depth) == Resume::Before) {
+            continue;
+          }
+          if(stats.IsCollecting()) {
+            ++stats.triedCount;
+            ++stats.acceptedCount;
+          }
+          if(Branch(board,
+                    blackList,
+                    pieceCounts,
+                    piecesCount,
+                    placedPieces,
+                    depth,
+                    hash,
+                    shapeIndex,
+                    coveringTable->masks[index],
+                    placementIndex)) {
+            return true;
+          }
 
-      // try another order of pieces (rotate left)
-      std::rotate(firstPiece, std::next(firstPiece), lastPiece);
+          if(IsStopping()) {
+            return false;
+          }
+        }
+      }
     }
 
+    CheckResumed();
+    if(transpositionTable) {
+      transpositionTable->StoreUnsolvable(hash, nodeCount - firstNodeCount);
+    }
     return false;
   }
+
+  // the block of the region filled by the fewest placements that fit,
+  // or the first one found filled by at most one
+  size_t GetFewestCandidatesBlock(BoardType const &board,
+                                  Mask region,
+                                  PieceCounts const &pieceCounts) const {
+    size_t minPos = 0;
+    auto minCount = std::numeric_limits<unsigned int>::max();
+    while(region.Any()) {
+      auto const pos = region.First();
+      region.Reset(pos);
+
+      unsigned int count = 0;
+      for(size_t shapeIndex = 0; (shapeIndex < pieceCounts.size()) && (count < minCount); ++shapeIndex) {
+        if(!pieceCounts[shapeIndex]) {
+          continue;
+        }
+        auto const end = coveringTable->End(pos, shapeIndex);
+        for(auto first = coveringTable->Begin(pos, shapeIndex); first < end; first += 64) {
+          count += bits::PopCount(Mask::Disjoint(&coveringTable->masks[first],
+                                                 std::min<size_t>(end - first, 64),
+                                                 board.Occupied()));
+        }
+      }
+      if(count < minCount) {
+        minCount = count;
+        minPos = pos;
+        if(count <= 1) {
+          break;
+        }
+      }
+    }
+    return minPos;
+  }
+
+  // insert the piece and search on, or leave the branch to an idle solver;
+  // the state is restored unless solved
+  bool Branch(BoardType &board,
+              BlackList &blackList,
+              PieceCounts &pieceCounts,
+              unsigned int piecesCount,
+              PlacedPieces &placedPieces,
+              size_t depth,
+              uint64_t hash,
+              size_t shapeIndex,
+              Mask const &mask,
+              size_t placementIndex) {
+    auto &&ccl = m_labelers[depth];
+    auto &&count = pieceCounts[shapeIndex];
+
+    // next iteration with updated board and piece counts
+    auto const id = static_cast<unsigned int>(placedPieces.size());
+    auto const childHash = (transpositionTable ?
+      transpositionTable->Hash(hash, placementIndex, shapeIndex, count) : 0);
+    placedPieces.push_back(PlacedPiece<Mask>{id, mask});
+    --count;
+    if(sharing && (piecesCount > minSharedPiecesCount) && sharing->WantsTask()) {
+      // leave this branch to an idle solver
+      BoardType child(board);
+      child.Insert(mask);
+      sharing->Share(Task{
+        child,
+        blackList,
+        pieceCounts,
+        piecesCount - 1,
+        placedPieces,
+        ConnectedComponentLabeler<Mask>(ccl, board, mask),
+        shapeIndex,
+        childHash
+      });
+    } else {
+      board.Insert(mask);
+      {
+        SearchStats::Timer timer(stats.Time(stats.labelingTime));
+        m_labelers[depth + 1].Relabel(ccl, board, mask);
+      }
+      if(stats.IsCollecting()) {
+        ++stats.labelingCount;
+      }
+      if(Solve(board,
+               blackList,
+               pieceCounts,
+               piecesCount - 1,
+               placedPieces,
+               depth + 1,
+               shapeIndex,
+               childHash)) {
+        return true;
+      }
+      board.Remove(mask);
+    }
+
+    ++count;
+    placedPieces.pop_back();
+    return false;
+  }
+
+  bool IsStopping() const {
+    return (isStopped || (sharing && sharing->IsCancelled()));
+  }
+
+  // where the branch of the node's current step is, when resuming the node;
+  // beneath the branch on the path, resumes the next node on the path
+  Resume GetResume(size_t depth) {
+    if(m_resumeDepth == noDepth) {
+      return Resume::None;
+    } else if(depth != m_resumeDepth) {
+      // the branch on the path did not lead to the next node on it
+      throw std::invalid_argument("Checkpoint does not match the puzzle");
+    }
+
+    auto &&step = m_path[depth];
+    auto &&resumed = (*resumePath)[depth];
+    if(step.branch < resumed.branch) {
+      return Resume::Before;
+    } else if((step.branch > resumed.branch) || (step.placement != resumed.placement)) {
+      throw std::invalid_argument("Checkpoint does not match the puzzle");
+    }
+    m_resumeDepth = ((depth + 1 < resumePath->size()) ? depth + 1 : noDepth);
+    return Resume::At;
+  }
+
+  // a node's branches are done only after resuming the whole path
+  void CheckResumed() const {
+    if(m_resumeDepth != noDepth) {
+      throw std::invalid_argument("Checkpoint does not match the puzzle");
+    }
+  }
+
+  void BlackListAt(BlackList &blackList, size_t index) {
+    blackList.Set(index);
+    m_blackListed.push_back(index);
+  }
+
+  // undo the blacklist entries beyond the given number
+  void RestoreBlackList(BlackList &blackList, size_t blackListedCount) {
+    while(m_blackListed.size() > blackListedCount) {
+      blackList.Reset(m_blackListed.back());
+      m_blackListed.pop_back();
+    }
+  }
+
+  // branches with few pieces left are not worth sharing
+  enum {
+    minSharedPiecesCount = 3
+  };
+
+  PlacementTable<Mask> const &m_placementTable;
+  std::vector<ConnectedComponentLabeler<Mask>> m_labelers; // per depth
+  std::vector<size_t> m_blackListed; // blacklist bits in the order of setting
+  std::vector<Step> m_path; // per depth, the current branch
+  unsigned long long m_uncheckedNodeCount; // since checking the limits
+  size_t m_resumeDepth; // of the node on the resumed path to be searched next
+  size_t m_stopDepth;
 };
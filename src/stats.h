@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+// counters of the search; each solver keeps its own
+// and they are added up when the search has ended;
+// collected only if enabled at runtime
+// and left out entirely when compiled without SEARCH_STATS
+struct SearchStats {
+  using Clock = std::chrono::steady_clock;
+
+  enum : bool {
+#ifdef SEARCH_STATS
+    isCompiled = true
+#else
+    isCompiled = false
+#endif
+  };
+
+  // adds the time until leaving the scope to the duration, if any
+  struct Timer {
+    explicit Timer(Clock::duration *duration)
+      : m_duration(duration)
+      , m_start(duration ? Clock::now() : Clock::time_point()) {
+    }
+
+    ~Timer() {
+      if(m_duration) {
+        *m_duration += Clock::now() - m_start;
+      }
+    }
+
+  private:
+    Clock::duration *m_duration;
+    Clock::time_point m_start;
+  };
+
+  bool isEnabled;
+  std::vector<unsigned long long> nodeCounts; // per number of placed pieces
+  unsigned long long triedCount; // placements fitting into the smallest region
+  unsigned long long acceptedCount; // placements searched or shared
+  unsigned long long blackListHitCount;
+  unsigned long long symmetrySkipCount;
+  unsigned long long labelingCount;
+  Clock::duration labelingTime;
+  Clock::duration pruningTime;
+  Clock::duration searchTime; // including labeling and pruning
+
+  SearchStats()
+    : isEnabled(false)
+    , triedCount(0)
+    , acceptedCount(0)
+    , blackListHitCount(0)
+    , symmetrySkipCount(0)
+    , labelingCount(0)
+    , labelingTime(Clock::duration::zero())
+    , pruningTime(Clock::duration::zero())
+    , searchTime(Clock::duration::zero()) {
+  }
+
+  bool IsCollecting() const {
+    return (isCompiled && isEnabled);
+  }
+
+  // the duration to time if collecting, for a Timer
+  Clock::duration *Time(Clock::duration &duration) {
+    return (IsCollecting() ? &duration : nullptr);
+  }
+
+  // make room for counting nodes up to the depth before searching
+  void Reserve(size_t depth) {
+    if(IsCollecting() && (nodeCounts.size() <= depth)) {
+      nodeCounts.resize(depth + 1, 0);
+    }
+  }
+
+  void Accumulate(SearchStats const &other) {
+    Reserve(other.nodeCounts.size());
+    for(size_t depth = 0; depth < other.nodeCounts.size(); ++depth) {
+      nodeCounts[depth] += other.nodeCounts[depth];
+    }
+    triedCount += other.triedCount;
+    acceptedCount += other.acceptedCount;
+    blackListHitCount += other.blackListHitCount;
+    symmetrySkipCount += other.symmetrySkipCount;
+    labelingCount += other.labelingCount;
+    labelingTime += other.labelingTime;
+    pruningTime += other.pruningTime;
+    searchTime += other.searchTime;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, SearchStats const &stats) {
+    using Seconds = std::chrono::duration<double>;
+
+    os << "Nodes per depth:";
+    for(auto &&count : stats.nodeCounts) {
+      os << " " << count;
+    }
+    return os << "\nPlacements: " << stats.triedCount << " tried, "
+      << stats.acceptedCount << " searched, "
+      << stats.blackListHitCount << " blacklisted, "
+      << stats.symmetrySkipCount << " symmetric\n"
+      << "Labeling: " << stats.labelingCount << " calls in "
+      << Seconds(stats.labelingTime).count() << " s\n"
+      << "Time: " << Seconds(stats.searchTime).count() << " s searching, "
+      << Seconds(stats.labelingTime).count() << " s labeling, "
+      << Seconds(stats.pruningTime).count() << " s pruning, "
+      << Seconds(stats.searchTime - stats.labelingTime - stats.pruningTime).count()
+      << " s placing\n";
+  }
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "board.h"
+#include "placement.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+// the board's rotations and reflections that map the pieces onto themselves,
+// i.e. that turn any solution into another solution;
+// placements are numbered in the order the search tries them on the empty board
+template<typename Mask>
+struct Symmetries {
+  using PlacedPieces = std::vector<PlacedPiece<Mask>>;
+
+  Symmetries(Board<Mask> const &board,
+             PlacementTable<Mask> const &placementTable,
+             PieceCounts const &pieceCounts) {
+    std::vector<Mask> masks;
+    std::vector<size_t> shapeIndices;
+    for(size_t shapeIndex = 0; shapeIndex < placementTable.shapes.size(); ++shapeIndex) {
+      for(auto &&orientation : placementTable.shapes[shapeIndex].orientations) {
+        for(auto &&mask : orientation.masks) {
+          m_indices.emplace_back(mask, masks.size());
+          masks.push_back(mask);
+          shapeIndices.push_back(shapeIndex);
+        }
+      }
+    }
+    std::sort(begin(m_indices), end(m_indices),
+      [](std::pair<Mask, size_t> const &lhs, std::pair<Mask, size_t> const &rhs) -> bool {
+        return (lhs.first < rhs.first);
+      });
+
+    auto const sizeX = board.template sizeOf<0>();
+    auto const sizeY = board.template sizeOf<1>();
+    for(size_t transform = 0; transform < TransformCount; ++transform) {
+      if((transform >= Transpose) && (sizeX != sizeY)) {
+        // quarter turns only map square boards onto themselves
+        break;
+      }
+
+      std::vector<size_t> blocks;
+      for(size_t y = 0; y < sizeY; ++y) {
+        for(size_t x = 0; x < sizeX; ++x) {
+          auto const image = Apply(static_cast<Transform>(transform), x, y, sizeX, sizeY);
+          blocks.push_back(board.Offset(image.first, image.second));
+        }
+      }
+
+      // a shape may turn into another one, e.g. 'L' into 'J' when mirrored,
+      // which needs both to come in the same number
+      std::vector<size_t> images;
+      for(size_t i = 0; i < masks.size(); ++i) {
+        auto const image = IndexOf(Map(masks[i], blocks));
+        if((image == masks.size()) ||
+           (pieceCounts[shapeIndices[image]] != pieceCounts[shapeIndices[i]])) {
+          break;
+        }
+        images.push_back(image);
+      }
+      if(images.size() == masks.size()) {
+        m_images.push_back(std::move(images));
+      }
+    }
+  }
+
+  // number of symmetries including the identity
+  size_t GetCount() const {
+    return m_images.size();
+  }
+
+  // whether no symmetric image of the placement is tried before it;
+  // every solution has a symmetric one that starts with such a placement
+  bool IsCanonical(size_t placementIndex) const {
+    for(auto &&images : m_images) {
+      if(images[placementIndex] < placementIndex) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // number of distinct solutions symmetric to the solution,
+  // or 0 if it is not the first of them by sorted placement numbers
+  size_t OrbitSize(PlacedPieces const &placedPieces) const {
+    std::array<size_t, Mask::bitCount> solution;
+    std::array<size_t, Mask::bitCount> image;
+    auto const count = placedPieces.size();
+    for(size_t i = 0; i < count; ++i) {
+      solution[i] = IndexOf(placedPieces[i].mask);
+    }
+    std::sort(begin(solution), begin(solution) + count);
+
+    size_t stabilizerCount = 0;
+    for(auto &&images : m_images) {
+      for(size_t i = 0; i < count; ++i) {
+        image[i] = images[solution[i]];
+      }
+      std::sort(begin(image), begin(image) + count);
+
+      auto const mismatch = std::mismatch(begin(image), begin(image) + count, begin(solution));
+      if(mismatch.first == begin(image) + count) {
+        ++stabilizerCount;
+      } else if(*mismatch.first < *mismatch.second) {
+        return 0;
+      }
+    }
+    return m_images.size() / stabilizerCount;
+  }
+
+private:
+  enum Transform {
+    Identity,
+    MirrorX,
+    MirrorY,
+    HalfTurn,
+    Transpose,
+    QuarterTurnRight,
+    QuarterTurnLeft,
+    AntiTranspose,
+    TransformCount
+  };
+
+  static std::pair<size_t, size_t> Apply(Transform transform,
+                                         size_t x, size_t y,
+                                         size_t sizeX, size_t sizeY) {
+    switch(transform) {
+    case Identity:
+      return {x, y};
+    case MirrorX:
+      return {sizeX - 1 - x, y};
+    case MirrorY:
+      return {x, sizeY - 1 - y};
+    case HalfTurn:
+      return {sizeX - 1 - x, sizeY - 1 - y};
+    case Transpose:
+      return {y, x};
+    case QuarterTurnRight:
+      return {sizeY - 1 - y, x};
+    case QuarterTurnLeft:
+      return {y, sizeX - 1 - x};
+    default:
+      return {sizeY - 1 - y, sizeX - 1 - x};
+    }
+  }
+
+  static Mask Map(Mask mask, std::vector<size_t> const &blocks) {
+    Mask ret;
+    while(mask.Any()) {
+      auto const pos = mask.First();
+      mask.Reset(pos);
+      ret.Set(blocks[pos]);
+    }
+    return ret;
+  }
+
+  // placement number of a mask, or the number of placements if there is none
+  size_t IndexOf(Mask const &mask) const {
+    auto const it = std::lower_bound(begin(m_indices), end(m_indices), mask,
+      [](std::pair<Mask, size_t> const &entry, Mask const &value) -> bool {
+        return (entry.first < value);
+      });
+    if((it == end(m_indices)) || (it->first != mask)) {
+      return m_indices.size();
+    }
+    return it->second;
+  }
+
+private:
+  std::vector<std::pair<Mask, size_t>> m_indices; // sorted by mask
+  std::vector<std::vector<size_t>> m_images; // placement number per symmetry
+};
@@ -1,196 +1,497 @@
-#include "board.h"
 #include "color.h"
-#include "piece.h"
-#include "solver.h"
+#include "command_line.h"
+#include "generator.h"
+#include "puzzle.h"
+#include "render.h"
+#include "result_cache.h"
+#include "server.h"
+#include "solution_db.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <csignal>
+#include <fstream>
 #include <iostream>
-#include <limits>
-#include <numeric>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace {
 
+std::atomic<bool> stopRequest(false);
+
 void Cleanup(int) {
   std::cout << colorReset;
   exit(EXIT_SUCCESS);
 }
 
-struct CommandLineArguments {
-  size_t boardWidth;
-  size_t boardHeight;
-  unsigned int piecesCountI;
-  unsigned int piecesCountL;
-  unsigned int piecesCountJ;
-  unsigned int piecesCountT;
-  unsigned int piecesCountZ;
-  unsigned int piecesCountS;
-  unsigned int piecesCountO;
-
-  CommandLineArguments(int argc, char **argv)
-  try : piecesCountI(0)
-      , piecesCountL(0)
-      , piecesCountJ(0)
-      , piecesCountT(0)
-      , piecesCountZ(0)
-      , piecesCountS(0)
-      , piecesCountO(0) {
-    if((argc < 5) || (argc % 2 != 1)) {
-      throw std::invalid_argument("Invalid number of arguments");
-    } else {
-      bool gotWidth = false;
-      bool gotHeight = false;
-
-      for(int argi = 1; argi < argc; argi += 2) {
-        std::string const identifier = std::string(argv[argi]);
-        std::string const value = std::string(argv[argi + 1]);
-
-        if(identifier == "-w") {
-          ParseValue(boardWidth, value, "board width");
-          gotWidth = true;
-        } else if(identifier == "-h") {
-          ParseValue(boardHeight, value, "board height");
-          gotHeight = true;
-        } else if(identifier == "-I") {
-          ParseValue(piecesCountI, value, "number of 'I' pieces");
-        } else if(identifier == "-L") {
-          ParseValue(piecesCountL, value, "number of 'L' pieces");
-        } else if(identifier == "-J") {
-          ParseValue(piecesCountJ, value, "number of 'J' pieces");
-        } else if(identifier == "-T") {
-          ParseValue(piecesCountT, value, "number of 'T' pieces");
-        } else if(identifier == "-Z") {
-          ParseValue(piecesCountZ, value, "number of 'Z' pieces");
-        } else if(identifier == "-S") {
-          ParseValue(piecesCountS, value, "number of 'S' pieces");
-        } else if(identifier == "-O") {
-          ParseValue(piecesCountO, value, "number of 'O' pieces");
-        } else {
-          throw std::invalid_argument("Unknown argument: '" + identifier + "'");
-        }
+// the first signal stops the search, which then finishes its output
+// and saves a checkpoint if asked to, the next one exits at once
+void Stop(int signal) {
+  if(stopRequest.exchange(true)) {
+    Cleanup(signal);
+  }
+  std::signal(signal, Stop);
+}
+
+std::string EscapeCsv(std::string const &str) {
+  std::string ret = "\"";
+  for(auto c : str) {
+    if(c == '"') {
+      ret += '"';
+    }
+    ret += c;
+  }
+  return ret + "\"";
+}
+
+// one line per puzzle, with the placements as shape and block coordinates
+std::string FormatResult(CommandLineArguments::Format format,
+                         size_t lineNumber,
+                         std::string const &line,
+                         Result const &result,
+                         double seconds) {
+  static char const *const statusNames[] = {"solved", "unsolved", "invalid", "unknown"};
+  auto const status = statusNames[static_cast<size_t>(result.status)];
+
+  std::ostringstream os;
+  if(format == CommandLineArguments::Format::Json) {
+    os << "{\"line\":" << lineNumber
+      << ",\"puzzle\":\"" << EscapeJson(line)
+      << "\",\"status\":\"" << status
+      << "\",\"message\":\"" << EscapeJson(result.message)
+      << "\",\"seconds\":" << seconds
+      << ",\"nodes\":" << result.nodeCount
+      << ",\"solutions\":" << result.solutionCount
+      << ",\"placements\":" << RenderJson(result.placements)
+      << "}";
+  } else {
+    // pieces separated by ';', each as shape and 'x:y' per block
+    std::ostringstream placements;
+    for(size_t i = 0; i < result.placements.size(); ++i) {
+      auto &&placement = result.placements[i];
+      placements << (i ? ";" : "") << placement.shape;
+      for(auto &&block : placement.blocks) {
+        placements << " " << block.first << ":" << block.second;
       }
+    }
+    os << lineNumber
+      << "," << EscapeCsv(line)
+      << "," << status
+      << "," << EscapeCsv(result.message)
+      << "," << seconds
+      << "," << result.nodeCount
+      << "," << result.solutionCount
+      << "," << EscapeCsv(placements.str());
+  }
+  return os.str();
+}
 
-      if(!gotWidth || !gotHeight) {
-        throw std::invalid_argument("Board width and height must be provided");
+// solve the puzzle of a line of arguments, or take its result
+// from the database or the cache if given and holding the puzzle
+Result SolveLine(std::string const &line, SolutionDatabase const *db, ResultCache *cache) {
+  Result result;
+  result.status = Result::Status::Invalid;
+  try {
+    std::istringstream iss(line);
+    std::vector<std::string> args;
+    for(std::string arg; iss >> arg;) {
+      if(!args.empty() || (arg[0] == '-')) {
+        args.push_back(arg);
+      }
+    }
+    CommandLineArguments lineCmd(args);
+    lineCmd.puzzle.stopRequest = &stopRequest;
+    if(db && db->Find(lineCmd.puzzle, result)) {
+      return result;
+    } else if(!cache || !cache->Find(lineCmd.puzzle, result)) {
+      result = SolvePuzzle(lineCmd.puzzle, nullptr);
+      if(cache) {
+        cache->Store(lineCmd.puzzle, result);
       }
     }
   }
   catch(std::invalid_argument const &e) {
-    std::cout << e.what() << "\n\n";
-    std::cout << "Usage:\n" << argv[0];
-    std::cout << R"(
-  -w <board width>
-  -h <board height>
-  -I <number of 'I' pieces> (optional)
-  -L <number of 'L' pieces> (optional)
-  -J <number of 'J' pieces> (optional)
-  -T <number of 'T' pieces> (optional)
-  -Z <number of 'Z' pieces> (optional)
-  -S <number of 'S' pieces> (optional)
-  -O <number of 'O' pieces> (optional)
-)";
+    result.message = e.what();
+  }
+  return result;
+}
+
+// solve the puzzles of the batch file, one per line, on a pool of threads
+// and print a result line per puzzle in the order of the file;
+// empty lines and lines starting with '#' are skipped,
+// as is a leading program name so lines of a shell script can be used
+void SolveBatch(CommandLineArguments const &cmd, SolutionDatabase const *db) {
+  std::ifstream file;
+  if(cmd.batchPath != "-") {
+    file.open(cmd.batchPath);
+    if(!file) {
+      std::cerr << "Failed to open batch file '" << cmd.batchPath << "'\n";
+      exit(EXIT_FAILURE);
+    }
+  }
+  std::istream &is = (file.is_open() ? file : std::cin);
+
+  std::vector<std::pair<size_t, std::string>> lines;
+  size_t lineNumber = 0;
+  for(std::string line; std::getline(is, line);) {
+    ++lineNumber;
+    if(!line.empty() && (line.back() == '\r')) {
+      line.pop_back();
+    }
+    auto const first = line.find_first_not_of(" \t");
+    if((first != std::string::npos) && (line[first] != '#')) {
+      lines.emplace_back(lineNumber, line);
+    }
+  }
+
+  if(cmd.format == CommandLineArguments::Format::Csv) {
+    std::cout << "line,puzzle,status,message,seconds,nodes,solutions,placements\n";
+  }
+
+  std::vector<std::string> outputs(lines.size());
+  std::vector<bool> isDone(lines.size(), false);
+  size_t printedCount = 0;
+  std::mutex outputMutex;
+  std::atomic<size_t> nextIndex(0);
+
+  auto const work = [&]() {
+    for(size_t index; (index = nextIndex++) < lines.size();) {
+      auto &&line = lines[index].second;
+      auto const start = std::chrono::steady_clock::now();
+      auto const result = SolveLine(line, db, nullptr);
+      std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - start;
+      auto output = FormatResult(cmd.format, lines[index].first, line, result, duration.count());
+
+      // print in order as soon as all previous lines are done
+      std::lock_guard<std::mutex> lock(outputMutex);
+      outputs[index] = std::move(output);
+      isDone[index] = true;
+      while((printedCount < lines.size()) && isDone[printedCount]) {
+        std::cout << outputs[printedCount] << "\n";
+        outputs[printedCount].clear();
+        ++printedCount;
+      }
+      std::cout.flush();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for(unsigned int i = 1; i < cmd.puzzle.threadCount; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for(auto &&thread : threads) {
+    thread.join();
+  }
+}
+
+// answer puzzles as they are requested, with a result line per request line
+// as in batch mode; puzzles equivalent to one solved before are answered
+// from the cache, e.g. those on the transposed board; prints the cache's
+// hits and misses when stopped
+void Serve(CommandLineArguments const &cmd, SolutionDatabase const *db) {
+  ResultCache cache(cmd.cacheCapacity);
+  auto const handler = [&](size_t lineNumber, std::string const &line) -> std::string {
+    auto const start = std::chrono::steady_clock::now();
+    auto const result = SolveLine(line, db, &cache);
+    std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - start;
+    return FormatResult(cmd.format, lineNumber, line, result, duration.count());
+  };
+
+  if(cmd.servePath == "-") {
+    ServeStream(std::cin, std::cout, handler, stopRequest);
+  } else {
+    ServeSocket(cmd.servePath, handler, stopRequest);
+  }
+
+  // apart from the responses, which may be on stdout
+  std::cerr << "Cache: " << cache.hitCount << " hits, " << cache.missCount << " misses\n";
+}
+
+// solve the puzzles a solution database holds on a pool of threads
+// and write the database; puzzles whose search stopped at the limits
+// are left out
+void GenerateDatabase(CommandLineArguments const &cmd) {
+  std::ofstream file(cmd.generateDbPath, std::ios::binary);
+  if(!file) {
+    std::cerr << "Failed to open database file '" << cmd.generateDbPath << "'\n";
     exit(EXIT_FAILURE);
   }
 
-private:
-  template<typename T>
-  void ParseValue(T &value, std::string const &arg, std::string const &argName) {
-    long long num;
-    if(!(std::istringstream(arg) >> num) ||
-       (num < std::numeric_limits<T>::min()) ||
-       (num > std::numeric_limits<T>::max())) {
-      throw std::invalid_argument("Invalid " + argName + ": '" + arg + "'");
+  SolutionDatabase::Enumerator enumerator(cmd.maxBlockCount);
+  SolutionDatabase::Builder builder;
+  std::mutex enumeratorMutex;
+  std::atomic<unsigned long long> solvedCount(0);
+  std::atomic<unsigned long long> unsolvedCount(0);
+  std::atomic<unsigned long long> skippedCount(0);
+
+  auto const work = [&]() {
+    for(auto puzzle = cmd.puzzle;;) {
+      {
+        std::lock_guard<std::mutex> lock(enumeratorMutex);
+        if(stopRequest || !enumerator.Next(puzzle)) {
+          return;
+        }
+      }
+      // a thread per puzzle
+      puzzle.threadCount = 1;
+      puzzle.stopRequest = &stopRequest;
+
+      auto const result = SolvePuzzle(puzzle, nullptr);
+      if(!builder.Add(puzzle, result)) {
+        ++skippedCount;
+      } else if(result.status == Result::Status::Solved) {
+        ++solvedCount;
+      } else {
+        ++unsolvedCount;
+      }
     }
-    value = static_cast<T>(num);
+  };
+
+  std::vector<std::thread> threads;
+  for(unsigned int i = 1; i < cmd.puzzle.threadCount; ++i) {
+    threads.emplace_back(work);
   }
+  work();
+  for(auto &&thread : threads) {
+    thread.join();
+  }
+
+  builder.Write(file);
+  if(!file.flush()) {
+    std::cerr << "Failed to write database file '" << cmd.generateDbPath << "'\n";
+    exit(EXIT_FAILURE);
+  }
+  std::cout << "Puzzles: " << solvedCount << " solved, " << unsolvedCount << " unsolved, "
+    << skippedCount << " left out\n";
+}
+
+// print random puzzles of the board size in batch file format, each after
+// a comment of whether it is solvable and the search nodes it takes
+void Generate(CommandLineArguments const &cmd) {
+  static char const *const difficultyNames[] = {"any", "easy", "medium", "hard"};
+  auto const getDifficulty = [](Result const &result) {
+    if(result.status == Result::Status::Unknown) {
+      return CommandLineArguments::Difficulty::Hard;
+    } else if(result.nodeCount < 1000) {
+      return CommandLineArguments::Difficulty::Easy;
+    } else if(result.nodeCount < 100000) {
+      return CommandLineArguments::Difficulty::Medium;
+    }
+    return CommandLineArguments::Difficulty::Hard;
+  };
+
+  PuzzleGenerator generator(cmd.puzzle.boardWidth, cmd.puzzle.boardHeight, cmd.seed);
+  std::mt19937_64 random(cmd.seed + 1); // of whether to swap a piece
+  size_t count = 0;
+  size_t attemptCount = 0;
+  for(; (count < cmd.generateCount) && (attemptCount < 100 * cmd.generateCount) && !stopRequest; ++attemptCount) {
+    // scored with the search arguments given
+    auto puzzle = cmd.puzzle;
+    auto const generated = generator.GenerateSolvable();
+    puzzle.piecesCountI = generated.piecesCountI;
+    puzzle.piecesCountL = generated.piecesCountL;
+    puzzle.piecesCountJ = generated.piecesCountJ;
+    puzzle.piecesCountT = generated.piecesCountT;
+    puzzle.piecesCountZ = generated.piecesCountZ;
+    puzzle.piecesCountS = generated.piecesCountS;
+    puzzle.piecesCountO = generated.piecesCountO;
+    puzzle.stopRequest = &stopRequest;
+
+    Result result;
+    if(random() % 100 < cmd.nearMissPercent) {
+      // a few tries to swap a piece so the puzzle becomes unsolvable
+      bool isSwapped = false;
+      for(int i = 0; (i < 10) && !isSwapped; ++i) {
+        auto const swapped = generator.SwapPiece(puzzle);
+        result = SolvePuzzle(swapped, nullptr);
+        if(result.status != Result::Status::Solved) {
+          puzzle = swapped;
+          isSwapped = true;
+        }
+      }
+      if(!isSwapped) {
+        continue;
+      }
+    } else {
+      result = SolvePuzzle(puzzle, nullptr);
+    }
+
+    auto const difficulty = getDifficulty(result);
+    if((cmd.difficulty != CommandLineArguments::Difficulty::Any) && (difficulty != cmd.difficulty)) {
+      continue;
+    }
+    ++count;
+    static char const *const statusNames[] = {"solvable", "unsolvable", "invalid", "unknown"};
+    std::cout << "# " << count << ": "
+      << statusNames[static_cast<size_t>(result.status)] << ", "
+      << result.nodeCount << " nodes (" << difficultyNames[static_cast<size_t>(difficulty)] << ")\n"
+      << PuzzleGenerator::ToArgs(puzzle) << std::endl;
+  }
+  if(count < cmd.generateCount) {
+    std::cerr << "Generated " << count << " of " << cmd.generateCount << " puzzles\n";
+  }
+}
+
+std::string Render(CommandLineArguments const &cmd, Result::Placements const &placements) {
+  switch(cmd.render) {
+  case CommandLineArguments::Render::Ansi:
+    return RenderAnsi(cmd.puzzle.boardWidth, cmd.puzzle.boardHeight, placements);
+  case CommandLineArguments::Render::Plain:
+    return RenderPlain(cmd.puzzle.boardWidth, cmd.puzzle.boardHeight, placements);
+  default:
+    return RenderJson(placements);
+  }
+}
+
+// print notes and solutions as they are found
+struct PrintingSink : SolutionSink {
+  explicit PrintingSink(CommandLineArguments const &cmd)
+    : m_cmd(cmd) {
+  }
+
+  void Note(std::string const &text) override {
+    std::cout << text << "\n";
+  }
+
+  Action Receive(Result::Placements const &placements, bool) override {
+    std::cout << Render(m_cmd, placements) << "\n\n";
+    return Action::Continue;
+  }
+
+private:
+  CommandLineArguments const &m_cmd;
 };
 
+void PrintStats(Result const &result) {
+  std::cout << "Nodes: " << result.nodeCount << "\n";
+  if(!result.prunedCounts.empty()) {
+    if(SearchStats::isCompiled) {
+      std::cout << result.stats;
+    } else {
+      std::cout << "Search statistics not compiled in (SEARCH_STATS)\n";
+    }
+    std::cout << "Pruned:";
+    for(size_t i = 0; i < result.prunedCounts.size(); ++i) {
+      std::cout << (i ? ", " : " ") << result.prunedCounts[i].first << " " << result.prunedCounts[i].second;
+    }
+    std::cout << "\n";
+  }
+  if(!result.transpositionCounts.empty()) {
+    std::cout << "Transposition table:";
+    for(size_t i = 0; i < result.transpositionCounts.size(); ++i) {
+      std::cout << (i ? ", " : " ") << result.transpositionCounts[i].first << " " << result.transpositionCounts[i].second;
+    }
+    std::cout << "\n";
+  }
+}
+
+// the puzzle's arguments and where its search stopped, to resume it
+void SaveCheckpoint(CommandLineArguments const &cmd, Checkpoint const &checkpoint) {
+  std::ofstream file(cmd.checkpointPath);
+  file << CommandLineArguments::checkpointHeader << "\n"
+    << "args " << cmd.puzzleArgs << "\n";
+  WriteCheckpoint(file, checkpoint);
+  if(!file.flush()) {
+    std::cerr << "Failed to write checkpoint file '" << cmd.checkpointPath << "'\n";
+    exit(EXIT_FAILURE);
+  }
+  std::cout << "Checkpoint saved to '" << cmd.checkpointPath
+    << "', continue with --resume " << cmd.checkpointPath << "\n";
+}
+
 } // unnamed namespace
 
 int main(int argc, char **argv) {
   // set up Ctrl-C handler
-  if(std::signal(SIGINT, Cleanup)) {
+  if((std::signal(SIGINT, Stop) == SIG_ERR) || (std::signal(SIGTERM, Stop) == SIG_ERR)) {
     std::cerr << "Failed to register signal handler\n";
     return EXIT_FAILURE;
   }
 
   // parse command line arguments
   CommandLineArguments const cmd(argc, argv);
+  simd::SetLevel(cmd.simdLevel);
+
+  // a solution database is mapped, its puzzles are looked up in place
+  std::unique_ptr<SolutionDatabase> db;
+  if(!cmd.dbPath.empty()) {
+    try {
+      db.reset(new SolutionDatabase(cmd.dbPath));
+    }
+    catch(std::invalid_argument const &e) {
+      std::cerr << e.what() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
 
-  // create Board
-  Board board(cmd.boardWidth, cmd.boardHeight);
+  if(!cmd.generateDbPath.empty()) {
+    GenerateDatabase(cmd);
+    return EXIT_SUCCESS;
+  } else if(cmd.generateCount) {
+    try {
+      Generate(cmd);
+    }
+    catch(std::exception const &e) {
+      std::cerr << e.what() << "\n";
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  } else if(!cmd.batchPath.empty()) {
+    SolveBatch(cmd, db.get());
+    return EXIT_SUCCESS;
+  } else if(!cmd.servePath.empty()) {
+    Serve(cmd, db.get());
+    return EXIT_SUCCESS;
+  }
 
 #ifdef DEBUG_BOARD_COLOR
   // test Board print
+  hypervector<Color, 2> colors(cmd.puzzle.boardWidth, cmd.puzzle.boardHeight);
   unsigned int id = 0;
-  for(size_t y = 0; y < board.size(1); ++y) {
-    for(size_t x = 0; x < board.size(0); ++x) {
+  for(size_t y = 0; y < colors.size(1); ++y) {
+    for(size_t x = 0; x < colors.size(0); ++x) {
       auto const color = Color::FromId(id);
-      board.at(x, y) = color;
-      std::cout << board << " Board: color id " << id++
+      colors.at(x, y) = color;
+      std::cout << colors << " Board: color id " << id++
         << ", color " << color << colorReset << std::endl;
     }
   }
-  // restore empty board
-  board = Board(cmd.boardWidth, cmd.boardHeight);
 #endif
 
-  // create Pieces
-  std::vector<Piece> pieces;
-  for(unsigned int i = 0; i < cmd.piecesCountI; ++i) {
-    pieces.push_back(Piece::CreateI(static_cast<unsigned int>(pieces.size())));
-  }
-  for(unsigned int i = 0; i < cmd.piecesCountL; ++i) {
-    pieces.push_back(Piece::CreateL(static_cast<unsigned int>(pieces.size())));
-  }
-  for(unsigned int i = 0; i < cmd.piecesCountJ; ++i) {
-    pieces.push_back(Piece::CreateJ(static_cast<unsigned int>(pieces.size())));
-  }
-  for(unsigned int i = 0; i < cmd.piecesCountT; ++i) {
-    pieces.push_back(Piece::CreateT(static_cast<unsigned int>(pieces.size())));
-  }
-  for(unsigned int i = 0; i < cmd.piecesCountZ; ++i) {
-    pieces.push_back(Piece::CreateZ(static_cast<unsigned int>(pieces.size())));
+  auto puzzle = cmd.puzzle;
+  puzzle.stopRequest = &stopRequest;
+  PrintingSink sink(cmd);
+  Result result;
+  if(db && db->Find(puzzle, result)) {
+    sink.Note(result.message);
+    if(result.status == Result::Status::Solved) {
+      sink.Receive(result.placements, true);
+    }
+  } else {
+    result = SolvePuzzle(puzzle, &sink);
   }
-  for(unsigned int i = 0; i < cmd.piecesCountS; ++i) {
-    pieces.push_back(Piece::CreateS(static_cast<unsigned int>(pieces.size())));
+
+  if(cmd.puzzle.solutions != Puzzle::Solutions::First) {
+    std::cout << "Solutions: " << result.solutionCount
+      << " (" << result.canonicalSolutionCount << " up to "
+      << result.symmetryCount << " symmetries)\n"
+      << "Nodes: " << result.nodeCount << " in " << result.seconds << " s ("
+      << static_cast<unsigned long long>(result.nodeCount / std::max(result.seconds, 1e-9))
+      << " per second)\n";
   }
-  for(unsigned int i = 0; i < cmd.piecesCountO; ++i) {
-    pieces.push_back(Piece::CreateO(static_cast<unsigned int>(pieces.size())));
+  if(cmd.puzzle.isCollectingStats) {
+    PrintStats(result);
   }
-
-  auto const expectedPiecesBlockCount = cmd.boardWidth * cmd.boardHeight;
-  auto const receivedPiecesBlockCount = std::accumulate(
-    begin(pieces), end(pieces), static_cast<unsigned int>(0),
-    [](unsigned int sum, Piece const &piece) -> unsigned int {
-      return sum + piece.GetBlockCount();
-    });
-  if(receivedPiecesBlockCount > expectedPiecesBlockCount) {
-    std::cout << "Not solvable (too many pieces)\n";
-  } else {
-    if(receivedPiecesBlockCount < expectedPiecesBlockCount) {
-      std::cout << "Multiple solutions possible (too few pieces)\n";
-    }
-
-    Solver solver;
-
-    // prepare Solver optimizations
-    auto minBlockCount = std::numeric_limits<unsigned int>::max();
-    for(auto &&piece : pieces) {
-      minBlockCount = std::min(minBlockCount, piece.GetBlockCount());
-    }
-    solver.pieceMinimumBlockCount = minBlockCount;
-
-    // run recursive solver
-    if(!solver.Solve(std::move(board),
-                     Solver::BlackList(board.sizeOf<0>(), board.sizeOf<1>()),
-                     begin(pieces),
-                     end(pieces))) {
-      std::cout << "No exact solution found\n";
-    }
+  if(result.isResumable && !cmd.checkpointPath.empty()) {
+    SaveCheckpoint(cmd, result.checkpoint);
   }
 
   return EXIT_SUCCESS;
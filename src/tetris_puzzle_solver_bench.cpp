@@ -0,0 +1,377 @@
+#include "command_line.h"
+#include "puzzle.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <sys/resource.h>
+#endif
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+namespace {
+
+struct BenchPuzzle {
+  char const *name;
+  char const *args;
+};
+
+// the puzzles of test.sh, and larger ones found by random piece selection;
+// the unsolvable ones pass the parity pruning, so they are searched
+BenchPuzzle const corpus[] = {
+  {"test-1", "-w 8 -h 8 -T 4 -J 4 -L 1 -O 3 -Z 1 -S 1 -I 2"},
+  {"test-2", "-w 8 -h 6 -T 2 -J 3 -L 2 -O 2 -Z 2 -S 0 -I 1"},
+  {"test-3", "-w 8 -h 6 -T 2 -J 2 -L 0 -O 2 -Z 3 -S 2 -I 1"},
+  {"test-4", "-w 10 -h 4 -T 4 -J 1 -L 0 -O 0 -Z 2 -S 1 -I 2"},
+  {"test-5", "-w 10 -h 4 -T 4 -J 0 -L 2 -O 2 -Z 0 -S 1 -I 1"},
+  {"test-6", "-w 8 -h 5 -T 4 -J 1 -L 1 -O 0 -Z 2 -S 2 -I 0"},
+  {"test-7", "-w 8 -h 5 -T 4 -J 1 -L 2 -O 1 -Z 0 -S 0 -I 2"},
+  {"test-8", "-w 8 -h 5 -T 4 -J 1 -L 1 -O 0 -Z 2 -S 2 -I 0"},
+  {"test-9", "-w 8 -h 5 -T 2 -J 1 -L 1 -O 2 -Z 1 -S 1 -I 2"},
+  {"8x8-solved-1", "-w 8 -h 8 -I 4 -L 1 -J 3 -T 2 -Z 3 -S 2 -O 1"},
+  {"8x8-solved-2", "-w 8 -h 8 -I 3 -L 2 -J 4 -T 2 -Z 3 -S 1 -O 1"},
+  {"8x8-solved-3", "-w 8 -h 8 -T 16"},
+  {"9x8-solved-1", "-w 9 -h 8 -I 5 -L 1 -J 4 -T 2 -Z 1 -S 3 -O 2"},
+  {"9x8-solved-2", "-w 9 -h 8 -I 5 -L 3 -J 3 -T 2 -Z 3 -S 1 -O 1"},
+  {"10x8-solved-1", "-w 10 -h 8 -I 4 -L 2 -J 4 -T 4 -Z 3 -S 1 -O 2"},
+  {"10x10-solved-1", "-w 10 -h 10 -I 12 -L 2 -J 2 -O 9"},
+  {"10x10-solved-2", "-w 10 -h 10 -I 8 -T 14 -Z 3"},
+  {"6x6-unsolved-1", "-w 6 -h 6 -L 1 -J 1 -T 2 -Z 2 -S 3"},
+  {"8x8-unsolved-1", "-w 8 -h 8 -I 4 -Z 7 -S 1 -O 4"},
+  {"10x10-unsolved-1", "-w 10 -h 10 -I 5 -Z 10 -S 2 -O 8"},
+  {"10x10-unsolved-2", "-w 10 -h 10 -L 6 -T 2 -Z 17"},
+  {"6x6-count-1", "-w 6 -h 6 -L 3 -J 3 -T 2 -O 1 --count"},
+  {"10x4-count-1", "-w 10 -h 4 -L 2 -J 2 -I 4 -O 2 --count"},
+  {"6x8-count-1", "-w 6 -h 8 -L 4 -J 4 -T 2 -O 2 --count"},
+  {"8x6-count-1", "-w 8 -h 6 -T 2 -J 2 -L 2 -O 2 -Z 1 -S 1 -I 2 --count"}
+};
+
+// counters of the CPU for the calling thread, where the OS provides them
+struct HardwareCounters {
+  HardwareCounters()
+    : m_cycles(-1)
+    , m_cacheMisses(-1) {
+#ifdef __linux__
+    m_cycles = Open(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if(m_cycles >= 0) {
+      m_cacheMisses = Open(PERF_COUNT_HW_CACHE_MISSES, m_cycles);
+    }
+#endif
+  }
+
+  ~HardwareCounters() {
+#ifdef __linux__
+    if(m_cacheMisses >= 0) {
+      close(m_cacheMisses);
+    }
+    if(m_cycles >= 0) {
+      close(m_cycles);
+    }
+#endif
+  }
+
+  bool IsAvailable() const {
+    return (m_cacheMisses >= 0);
+  }
+
+  void Start() {
+#ifdef __linux__
+    if(IsAvailable()) {
+      ioctl(m_cycles, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(m_cycles, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  // cycles and cache misses since Start
+  void Stop(long long &cycles, long long &cacheMisses) {
+    cycles = -1;
+    cacheMisses = -1;
+#ifdef __linux__
+    if(IsAvailable()) {
+      ioctl(m_cycles, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      uint64_t value;
+      if(read(m_cycles, &value, sizeof(value)) == sizeof(value)) {
+        cycles = static_cast<long long>(value);
+      }
+      if(read(m_cacheMisses, &value, sizeof(value)) == sizeof(value)) {
+        cacheMisses = static_cast<long long>(value);
+      }
+    }
+#endif
+  }
+
+private:
+#ifdef __linux__
+  static int Open(uint64_t config, int groupFd) {
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = (groupFd < 0 ? 1 : 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+  }
+#endif
+
+private:
+  int m_cycles;
+  int m_cacheMisses;
+};
+
+// largest resident set size of the process so far, -1 if unknown
+long long GetPeakRssKilobytes() {
+#if defined(__unix__) || defined(__APPLE__)
+  rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0) {
+# ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+# else
+    return usage.ru_maxrss;
+# endif
+  }
+#endif
+  return -1;
+}
+
+struct Measurement {
+  std::string name;
+  std::string status;
+  double seconds; // fastest of all repetitions
+  unsigned long long nodeCount;
+  long long peakRssKilobytes;
+  long long cycles; // -1 if unavailable
+  long long cacheMisses; // -1 if unavailable
+};
+
+Measurement Measure(BenchPuzzle const &puzzle,
+                    std::string const &extraArgs,
+                    unsigned int repeatCount,
+                    HardwareCounters &counters) {
+  std::istringstream iss(std::string(puzzle.args) + " " + extraArgs);
+  std::vector<std::string> args;
+  for(std::string arg; iss >> arg;) {
+    args.push_back(arg);
+  }
+  CommandLineArguments const cmd(args);
+
+  static char const *const statusNames[] = {"solved", "unsolved", "invalid", "unknown"};
+  Measurement measurement{puzzle.name, {}, std::numeric_limits<double>::max(), 0, -1, -1, -1};
+  for(unsigned int i = 0; i < repeatCount; ++i) {
+    long long cycles;
+    long long cacheMisses;
+    counters.Start();
+    auto const start = std::chrono::steady_clock::now();
+    auto const result = SolvePuzzle(cmd.puzzle, nullptr);
+    std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - start;
+    counters.Stop(cycles, cacheMisses);
+
+    if(duration.count() < measurement.seconds) {
+      measurement.seconds = duration.count();
+      measurement.cycles = cycles;
+      measurement.cacheMisses = cacheMisses;
+    }
+    measurement.status = statusNames[static_cast<size_t>(result.status)];
+    measurement.nodeCount = result.nodeCount;
+  }
+  measurement.peakRssKilobytes = GetPeakRssKilobytes();
+  return measurement;
+}
+
+std::string FormatCounter(long long value) {
+  return (value < 0 ? std::string("null") : std::to_string(value));
+}
+
+// one puzzle per line, so a baseline can be read back line by line
+void WriteJson(std::ostream &os, std::vector<Measurement> const &measurements) {
+  os << "{\n  \"puzzles\": [\n";
+  for(size_t i = 0; i < measurements.size(); ++i) {
+    auto &&m = measurements[i];
+    os << "    {\"name\":\"" << m.name
+      << "\",\"status\":\"" << m.status
+      << "\",\"seconds\":" << m.seconds
+      << ",\"nodes\":" << m.nodeCount
+      << ",\"nodesPerSecond\":" << static_cast<unsigned long long>(m.nodeCount / std::max(m.seconds, 1e-9))
+      << ",\"peakRssKb\":" << FormatCounter(m.peakRssKilobytes)
+      << ",\"cycles\":" << FormatCounter(m.cycles)
+      << ",\"cacheMisses\":" << FormatCounter(m.cacheMisses)
+      << "}" << (i + 1 < measurements.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n}\n";
+}
+
+// value following the key in a line written by WriteJson
+std::string FindValue(std::string const &line, std::string const &key) {
+  auto const pos = line.find("\"" + key + "\":");
+  if(pos == std::string::npos) {
+    return std::string();
+  }
+  auto begin = pos + key.size() + 3;
+  if(line[begin] == '"') {
+    ++begin;
+    return line.substr(begin, line.find('"', begin) - begin);
+  }
+  return line.substr(begin, line.find_first_of(",}", begin) - begin);
+}
+
+// report puzzles that got slower than the tolerance allows, by more
+// than the noise of timing short runs, that need more search nodes
+// or that changed their status
+bool Compare(std::string const &baselinePath,
+             std::vector<Measurement> const &measurements,
+             double tolerance,
+             double noiseSeconds) {
+  std::ifstream file(baselinePath);
+  if(!file) {
+    std::cerr << "Failed to open baseline '" << baselinePath << "'\n";
+    exit(EXIT_FAILURE);
+  }
+  std::map<std::string, Measurement> baseline;
+  for(std::string line; std::getline(file, line);) {
+    auto const name = FindValue(line, "name");
+    if(!name.empty()) {
+      baseline[name] = Measurement{
+        name,
+        FindValue(line, "status"),
+        std::atof(FindValue(line, "seconds").c_str()),
+        std::strtoull(FindValue(line, "nodes").c_str(), nullptr, 10),
+        -1,
+        -1,
+        -1
+      };
+    }
+  }
+
+  bool isRegressed = false;
+  for(auto &&m : measurements) {
+    auto const it = baseline.find(m.name);
+    if(it == end(baseline)) {
+      std::cerr << m.name << ": not in baseline\n";
+      continue;
+    }
+    auto &&b = it->second;
+    std::ostringstream note;
+    if(m.status != b.status) {
+      note << " status " << b.status << " -> " << m.status;
+    }
+    if(m.nodeCount > b.nodeCount) {
+      note << " nodes " << b.nodeCount << " -> " << m.nodeCount;
+    }
+    if((m.seconds > b.seconds * tolerance) && (m.seconds > b.seconds + noiseSeconds)) {
+      note << " seconds " << b.seconds << " -> " << m.seconds;
+    }
+    std::cerr << m.name << ": " << (note.str().empty() ? "ok" : "REGRESSION") << note.str()
+      << " (" << m.seconds / std::max(b.seconds, 1e-9) << "x time)\n";
+    isRegressed |= !note.str().empty();
+  }
+  return !isRegressed;
+}
+
+void PrintUsage(char const *program) {
+  std::cout << "Usage:\n" << program << R"(
+  --repeat <number of runs per puzzle, the fastest counts> (optional, default 3)
+  --filter <substring of the puzzle names to run> (optional)
+  --output <JSON file> (optional, default stdout)
+  --compare <baseline JSON file written by --output before> (optional)
+  --tolerance <factor of the baseline time to flag as slower> (optional, default 1.25)
+  --noise <seconds a puzzle may be slower than the baseline regardless of the tolerance> (optional, default 0.002)
+  --simd <scalar|sse2|avx2> (optional, instruction set for boards of over 128 blocks)
+  --args <solver arguments added to each puzzle's, e.g. "--branching first"> (optional)
+)";
+}
+
+} // unnamed namespace
+
+int main(int argc, char **argv) {
+  unsigned int repeatCount = 3;
+  std::string filter;
+  std::string outputPath;
+  std::string baselinePath;
+  std::string extraArgs;
+  double tolerance = 1.25;
+  double noiseSeconds = 0.002;
+  for(int argi = 1; argi < argc; argi += 2) {
+    std::string const identifier = argv[argi];
+    if(argi + 1 == argc) {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    std::string const value = argv[argi + 1];
+    if(identifier == "--repeat") {
+      repeatCount = static_cast<unsigned int>(std::max(1, std::atoi(value.c_str())));
+    } else if(identifier == "--filter") {
+      filter = value;
+    } else if(identifier == "--output") {
+      outputPath = value;
+    } else if(identifier == "--compare") {
+      baselinePath = value;
+    } else if(identifier == "--tolerance") {
+      tolerance = std::atof(value.c_str());
+    } else if(identifier == "--noise") {
+      noiseSeconds = std::atof(value.c_str());
+    } else if(identifier == "--args") {
+      extraArgs = value;
+    } else if(identifier == "--simd") {
+      try {
+        simd::SetLevel(CommandLineArguments::ParseSimdLevel(value));
+      }
+      catch(std::invalid_argument const &e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+      }
+    } else {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  HardwareCounters counters;
+  if(!counters.IsAvailable()) {
+    std::cerr << "Hardware counters unavailable\n";
+  }
+
+  std::vector<Measurement> measurements;
+  for(auto &&puzzle : corpus) {
+    if(std::string(puzzle.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    measurements.push_back(Measure(puzzle, extraArgs, repeatCount, counters));
+
+    auto &&m = measurements.back();
+    std::cerr << m.name << ": " << m.status
+      << ", " << m.seconds << " s"
+      << ", " << m.nodeCount << " nodes"
+      << ", " << static_cast<unsigned long long>(m.nodeCount / std::max(m.seconds, 1e-9)) << " nodes/s"
+      << ", " << FormatCounter(m.cycles) << " cycles"
+      << ", " << FormatCounter(m.cacheMisses) << " cache misses\n";
+  }
+
+  if(outputPath.empty()) {
+    WriteJson(std::cout, measurements);
+  } else {
+    std::ofstream file(outputPath);
+    WriteJson(file, measurements);
+  }
+
+  if(!baselinePath.empty() && !Compare(baselinePath, measurements, tolerance, noiseSeconds)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
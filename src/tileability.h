@@ -0,0 +1,206 @@
+#pragma once
+
+#include "board.h"
+#include "placement.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+// the small regions the puzzle's shapes can fill exactly, by their blocks
+// moved to the board's corner, with the numbers of pieces per shape
+// of each way to fill them; a small region that is not listed,
+// or only with more pieces than remain, cannot be filled
+template<typename Mask>
+struct TileabilityTable {
+  size_t maxBlockCount; // of the listed regions
+
+  // lists the regions of up to maxBlockCount blocks that fit into the board
+  TileabilityTable(Board<Mask> const &board,
+                   PlacementTable<Mask> const &placementTable,
+                   size_t maxBlockCount)
+    : maxBlockCount(maxBlockCount)
+    , m_shapeCount(placementTable.shapes.size()) {
+    // the orientations' blocks, at the origin
+    auto const boardWidth = static_cast<int>(board.template sizeOf<0>());
+    std::vector<std::pair<size_t, Blocks>> orientations;
+    for(size_t shapeIndex = 0; shapeIndex < placementTable.shapes.size(); ++shapeIndex) {
+      for(auto &&orientation : placementTable.shapes[shapeIndex].orientations) {
+        Blocks blocks;
+        for(auto mask = orientation.At(0, 0); mask.Any();) {
+          auto const pos = mask.First();
+          mask.Reset(pos);
+          blocks.emplace_back(static_cast<int>(pos) % boardWidth, static_cast<int>(pos) / boardWidth);
+        }
+        orientations.emplace_back(shapeIndex, Normalize(blocks));
+      }
+    }
+
+    // unions of pieces, each adjacent to the ones before, by size;
+    // any region a number of pieces fill is reached so
+    std::map<Blocks, std::vector<Counts>> regions;
+    std::map<Blocks, std::vector<Counts>> added;
+    for(auto &&orientation : orientations) {
+      if(orientation.second.size() <= maxBlockCount) {
+        Counts counts(m_shapeCount, 0);
+        ++counts[orientation.first];
+        AddCounts(added[orientation.second], counts);
+      }
+    }
+    auto const boardHeight = static_cast<int>(board.template sizeOf<1>());
+    Blocks merged;
+    while(!added.empty()) {
+      std::map<Blocks, std::vector<Counts>> next;
+      for(auto &&region : added) {
+        for(auto &&counts : region.second) {
+          AddCounts(regions[region.first], counts);
+        }
+
+        auto const sizeX = GetSize(region.first).first;
+        auto const sizeY = GetSize(region.first).second;
+        for(auto &&orientation : orientations) {
+          if(region.first.size() + orientation.second.size() > maxBlockCount) {
+            continue;
+          }
+          auto const size = GetSize(orientation.second);
+          for(int y = -size.second; y <= sizeY; ++y) {
+            for(int x = -size.first; x <= sizeX; ++x) {
+              // unions only grow, so one that does not fit into the board never will
+              if((std::max(x + size.first, sizeX) - std::min(x, 0) > boardWidth) ||
+                 (std::max(y + size.second, sizeY) - std::min(y, 0) > boardHeight) ||
+                 !Merge(region.first, orientation.second, x, y, merged)) {
+                continue;
+              }
+              auto &&mergedCounts = next[merged];
+              for(auto counts : region.second) {
+                ++counts[orientation.first];
+                AddCounts(mergedCounts, counts);
+              }
+            }
+          }
+        }
+      }
+      added = std::move(next);
+    }
+
+    // as board masks, sorted to look them up
+    for(auto &&region : regions) {
+      auto const size = GetSize(region.first);
+      if((size.first > boardWidth) || (size.second > boardHeight)) {
+        continue;
+      }
+      Mask mask;
+      for(auto &&block : region.first) {
+        mask.Set(board.Offset(static_cast<size_t>(block.first), static_cast<size_t>(block.second)));
+      }
+      m_entries.push_back(Entry{mask, m_counts.size() / m_shapeCount, region.second.size()});
+      for(auto &&counts : region.second) {
+        m_counts.insert(end(m_counts), begin(counts), end(counts));
+      }
+    }
+    std::sort(begin(m_entries), end(m_entries),
+      [](Entry const &lhs, Entry const &rhs) -> bool {
+        return (lhs.region < rhs.region);
+      });
+  }
+
+  // whether the remaining pieces may fill the region, given at the corner
+  bool MayFill(Mask const &region, PieceCounts const &pieceCounts) const {
+    auto const entry = std::lower_bound(begin(m_entries), end(m_entries), region,
+      [](Entry const &lhs, Mask const &rhs) -> bool {
+        return (lhs.region < rhs);
+      });
+    if((entry == end(m_entries)) || (entry->region != region)) {
+      return false;
+    }
+
+    for(size_t i = 0; i < entry->countsCount; ++i) {
+      auto const counts = &m_counts[(entry->firstCounts + i) * m_shapeCount];
+      bool isAvailable = true;
+      for(size_t shapeIndex = 0; (shapeIndex < m_shapeCount) && isAvailable; ++shapeIndex) {
+        isAvailable = (counts[shapeIndex] <= pieceCounts[shapeIndex]);
+      }
+      if(isAvailable) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  size_t GetSize() const {
+    return m_entries.size();
+  }
+
+private:
+  using Blocks = std::vector<std::pair<int, int>>; // sorted, at the origin
+  using Counts = std::vector<unsigned char>; // pieces per shape
+
+  struct Entry {
+    Mask region;
+    size_t firstCounts; // index of its first pieces per shape
+    size_t countsCount; // number of ways to fill it
+  };
+
+  static Blocks Normalize(Blocks blocks) {
+    auto minX = blocks.front().first;
+    auto minY = blocks.front().second;
+    for(auto &&block : blocks) {
+      minX = std::min(minX, block.first);
+      minY = std::min(minY, block.second);
+    }
+    for(auto &&block : blocks) {
+      block.first -= minX;
+      block.second -= minY;
+    }
+    std::sort(begin(blocks), end(blocks));
+    return blocks;
+  }
+
+  // width and height of normalized blocks
+  static std::pair<int, int> GetSize(Blocks const &blocks) {
+    std::pair<int, int> size(0, 0);
+    for(auto &&block : blocks) {
+      size.first = std::max(size.first, block.first + 1);
+      size.second = std::max(size.second, block.second + 1);
+    }
+    return size;
+  }
+
+  // the region and the piece moved by x and y, if they do not overlap
+  // and the piece is next to the region
+  static bool Merge(Blocks const &region, Blocks const &piece, int x, int y, Blocks &merged) {
+    bool isAdjacent = false;
+    for(auto &&block : piece) {
+      auto const moved = std::make_pair(block.first + x, block.second + y);
+      if(std::binary_search(begin(region), end(region), moved)) {
+        return false;
+      }
+      isAdjacent = isAdjacent ||
+        std::binary_search(begin(region), end(region), std::make_pair(moved.first - 1, moved.second)) ||
+        std::binary_search(begin(region), end(region), std::make_pair(moved.first + 1, moved.second)) ||
+        std::binary_search(begin(region), end(region), std::make_pair(moved.first, moved.second - 1)) ||
+        std::binary_search(begin(region), end(region), std::make_pair(moved.first, moved.second + 1));
+    }
+    if(!isAdjacent) {
+      return false;
+    }
+    merged = region;
+    for(auto &&block : piece) {
+      merged.emplace_back(block.first + x, block.second + y);
+    }
+    merged = Normalize(std::move(merged));
+    return true;
+  }
+
+  static void AddCounts(std::vector<Counts> &countsList, Counts const &counts) {
+    if(std::find(begin(countsList), end(countsList), counts) == end(countsList)) {
+      countsList.push_back(counts);
+    }
+  }
+
+  size_t m_shapeCount;
+  std::vector<Entry> m_entries; // sorted by region
+  std::vector<unsigned char> m_counts; // pieces per shape, per way to fill an entry's region
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "placement.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// search states proven to have no solution, i.e. the occupied blocks
+// and the number of remaining pieces per shape, reached again
+// by inserting the same pieces in a different order;
+// states are identified by Zobrist hashes, updated per inserted piece
+template<typename Mask>
+struct TranspositionTable {
+  unsigned long long hitCount;
+  unsigned long long missCount;
+  unsigned long long storeCount;
+
+  // the table takes up to byteCount bytes
+  TranspositionTable(PlacementTable<Mask> const &placementTable,
+                     PieceCounts const &pieceCounts,
+                     size_t byteCount)
+    : hitCount(0)
+    , missCount(0)
+    , storeCount(0)
+    , m_bucketMask(0) {
+    // fixed seed to search the same way each run
+    std::mt19937_64 random(0x7e7215);
+
+    std::vector<uint64_t> blockKeys(Mask::bitCount);
+    for(auto &&key : blockKeys) {
+      key = random();
+    }
+    for(auto &&shape : placementTable.shapes) {
+      for(auto &&orientation : shape.orientations) {
+        for(auto mask : orientation.masks) {
+          uint64_t key = 0;
+          while(mask.Any()) {
+            auto const pos = mask.First();
+            mask.Reset(pos);
+            key ^= blockKeys[pos];
+          }
+          m_placementKeys.push_back(key);
+        }
+      }
+    }
+
+    for(auto &&count : pieceCounts) {
+      std::vector<uint64_t> countKeys(count + 1);
+      for(auto &&key : countKeys) {
+        key = random();
+      }
+      m_countKeys.push_back(std::move(countKeys));
+    }
+
+    // a power of two buckets to index by the lowest hash bits
+    size_t bucketCount = 1;
+    while(2 * bucketCount * sizeof(Bucket) <= byteCount) {
+      bucketCount *= 2;
+    }
+    m_buckets.resize(bucketCount);
+    m_bucketMask = bucketCount - 1;
+  }
+
+  // hash of the empty board with all pieces remaining
+  uint64_t Hash(PieceCounts const &pieceCounts) const {
+    uint64_t hash = 0;
+    for(size_t i = 0; i < pieceCounts.size(); ++i) {
+      hash ^= m_countKeys[i][pieceCounts[i]];
+    }
+    return hash;
+  }
+
+  // hash after inserting a piece of the shape,
+  // count being the number of its pieces remaining before
+  uint64_t Hash(uint64_t hash,
+                size_t placementIndex,
+                size_t shapeIndex,
+                unsigned int count) const {
+    return hash
+      ^ m_placementKeys[placementIndex]
+      ^ m_countKeys[shapeIndex][count]
+      ^ m_countKeys[shapeIndex][count - 1];
+  }
+
+  bool IsUnsolvable(uint64_t hash) {
+    auto &&bucket = m_buckets[hash & m_bucketMask];
+    for(auto &&entry : bucket.entries) {
+      if(entry.nodeCount && (entry.hash == hash)) {
+        ++hitCount;
+        return true;
+      }
+    }
+    ++missCount;
+    return false;
+  }
+
+  // the first entry keeps the state that took the most nodes to search,
+  // the second one the most recent state; a state taking the first
+  // entry's place moves the one it displaces to the second
+  void StoreUnsolvable(uint64_t hash, unsigned long long nodeCount) {
+    auto &&bucket = m_buckets[hash & m_bucketMask];
+    if(nodeCount >= bucket.entries[0].nodeCount) {
+      if(bucket.entries[0].hash != hash) {
+        bucket.entries[1] = bucket.entries[0];
+      }
+      bucket.entries[0] = Entry{hash, nodeCount};
+    } else {
+      bucket.entries[1] = Entry{hash, nodeCount};
+    }
+    ++storeCount;
+  }
+
+private:
+  struct Entry {
+    uint64_t hash;
+    unsigned long long nodeCount; // size of the searched subtree, 0 if unused
+  };
+
+  struct Bucket {
+    Entry entries[2];
+  };
+
+private:
+  std::vector<uint64_t> m_placementKeys; // per placement number
+  std::vector<std::vector<uint64_t>> m_countKeys; // per shape and remaining count
+  std::vector<Bucket> m_buckets;
+  size_t m_bucketMask;
+};
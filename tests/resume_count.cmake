@@ -0,0 +1,34 @@
+# count the solutions of a puzzle in slices, resuming from a checkpoint
+# until the search completes; the last slice may find no new solutions,
+# the puzzle must still be solved with the total of all slices
+# usage: cmake -DSOLVER=<tetris_puzzle_solver> -DWORK_DIR=<dir> -P resume_count.cmake
+
+set(checkpoint ${WORK_DIR}/resume_count.txt)
+file(REMOVE ${checkpoint})
+
+execute_process(
+  COMMAND ${SOLVER} -w 10 -h 4 -L 2 -J 2 -I 4 -O 2 --count --branching region
+    --max-nodes 100000 --checkpoint ${checkpoint}
+  OUTPUT_VARIABLE output
+  RESULT_VARIABLE result
+)
+foreach(slice RANGE 100)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Search failed:\n${output}")
+  elseif(NOT output MATCHES "Checkpoint saved")
+    break()
+  endif()
+  execute_process(
+    COMMAND ${SOLVER} --resume ${checkpoint} --checkpoint ${checkpoint} --max-nodes 1000000
+    OUTPUT_VARIABLE output
+    RESULT_VARIABLE result
+  )
+endforeach()
+
+if(output MATCHES "Checkpoint saved")
+  message(FATAL_ERROR "Search not completed:\n${output}")
+elseif(output MATCHES "No exact solution")
+  message(FATAL_ERROR "Puzzle not solved after resuming:\n${output}")
+elseif(NOT output MATCHES "Solutions: 4480 \\(1216 up to 4 symmetries\\)")
+  message(FATAL_ERROR "Wrong number of solutions after resuming:\n${output}")
+endif()